@@ -0,0 +1,101 @@
+#include "AnalysisCache.h"
+#include <cstdio>
+#include <fstream>
+
+using std::string;
+
+// Bump when the analyzer output or the file layout changes, so old files are ignored.
+static const char cache_magic[] = "FANC-CACHE 1\n";
+
+/* On disk: cache_magic, then per entry this header followed by the output bytes. */
+struct EntryHeader {
+    uint64_t key;
+    int32_t base_lineno;
+    int32_t eof_lineno;
+    int32_t failed;
+    uint32_t size;
+};
+
+/* ************************************************ */
+void KeyHasher::add(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        value ^= bytes[i];
+        value *= 1099511628211ULL;
+    }
+}
+
+/* ************************************************ */
+void KeyHasher::add(const string& text) {
+    add((int)text.size());
+    add(text.data(), text.size());
+}
+
+/* ************************************************ */
+void AnalysisCache::load(const string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(cache_magic) - 1];
+    if (!in.read(magic, sizeof(magic)) || string(magic, sizeof(magic)) != cache_magic)
+        return;
+    in.seekg(0, std::ios::end);
+    std::streamoff left = (std::streamoff)in.tellg() - (std::streamoff)sizeof(magic);
+    in.seekg(sizeof(magic));
+    EntryHeader header;
+    while (in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        left -= sizeof(header);
+        // A size past the end of the file means the file is corrupt; none of it is trusted then.
+        if (header.size > left) {
+            slots.clear();
+            return;
+        }
+        left -= header.size;
+        Slot slot;
+        slot.entry.base_lineno = header.base_lineno;
+        slot.entry.eof_lineno = header.eof_lineno;
+        slot.entry.failed = header.failed != 0;
+        slot.entry.output.resize(header.size);
+        if (!in.read(&slot.entry.output[0], header.size))
+            break;
+        slots[header.key] = std::move(slot);
+    }
+}
+
+/* ************************************************ */
+bool AnalysisCache::save(const string& path) const {
+    // Write aside and rename, so a crash or a concurrent reader never sees half a file.
+    string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(cache_magic, sizeof(cache_magic) - 1);
+        for (const auto& key_slot : slots) {
+            if (!key_slot.second.used)
+                continue;
+            const CacheEntry& entry = key_slot.second.entry;
+            EntryHeader header = { key_slot.first, entry.base_lineno, entry.eof_lineno, entry.failed, (uint32_t)entry.output.size() };
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(entry.output.data(), entry.output.size());
+        }
+        if (!out.flush())
+            return false;
+    }
+    return rename(temp_path.c_str(), path.c_str()) == 0;
+}
+
+/* ************************************************ */
+const CacheEntry* AnalysisCache::lookup(uint64_t key, int base_lineno, int eof_lineno) {
+    auto it = slots.find(key);
+    if (it == slots.end())
+        return nullptr;
+    it->second.used = true;
+    const CacheEntry& entry = it->second.entry;
+    if (entry.failed && (entry.base_lineno != base_lineno || entry.eof_lineno != eof_lineno))
+        return nullptr;
+    return &entry;
+}
+
+/* ************************************************ */
+void AnalysisCache::store(uint64_t key, const CacheEntry& entry) {
+    Slot& slot = slots[key];
+    slot.entry = entry;
+    slot.used = true;
+}
@@ -0,0 +1,47 @@
+#ifndef COMPIHW3_ANALYSISCACHE_H
+#define COMPIHW3_ANALYSISCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/* 64 bit FNV-1a over whatever the result of a check depends on. */
+class KeyHasher {
+public:
+    uint64_t value = 14695981039346656037ULL;
+    void add(const void* data, size_t size);
+    void add(int number) { add(&number, sizeof(number)); }
+    // Length first, so "ab","c" and "a","bc" differ.
+    void add(const std::string& text);
+};
+
+/* Stored result of checking one function body. */
+class CacheEntry {
+public:
+    int base_lineno; // Line of the first token of the function when the entry was made.
+    int eof_lineno;  // Line the parser saw at the end of the function.
+    bool failed;
+    std::string output;
+};
+
+/* Results of checking function bodies in earlier runs, kept in a file between runs.
+   A failed entry ends with an error that mentions a line number, so it is only reused while
+   the function stays on the same lines. */
+class AnalysisCache {
+public:
+    // A missing, truncated or foreign file gives an empty (or partial) cache.
+    void load(const std::string& path);
+    // Writes the entries looked up or stored since load; the others are dropped.
+    bool save(const std::string& path) const;
+    const CacheEntry* lookup(uint64_t key, int base_lineno, int eof_lineno);
+    void store(uint64_t key, const CacheEntry& entry);
+private:
+    class Slot {
+    public:
+        CacheEntry entry;
+        bool used = false;
+    };
+    std::unordered_map<uint64_t, Slot> slots;
+};
+
+#endif //COMPIHW3_ANALYSISCACHE_H
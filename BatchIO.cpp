@@ -0,0 +1,494 @@
+#include "BatchIO.h"
+#include "Prescan.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using std::string;
+
+/* A file being read. Tickets index a deque of these, so a slot never moves. */
+class ReadSlot {
+public:
+    int fd = -1;
+    string data;      // Sized to the file when it is opened.
+    size_t done = 0;  // Bytes read so far.
+    bool finished = false;
+    bool ok = false;
+};
+
+class PendingWrite {
+public:
+    int fd;
+    string data;
+    bool close_fd;
+    size_t done = 0;
+};
+
+/* ************************************************ */
+static void finish_write(const PendingWrite& write) {
+    if (write.close_fd)
+        close(write.fd);
+}
+
+/* Opens path for slot. Returns true if its bytes still have to be read; otherwise the slot is finished,
+   after an error, for an empty file, or for a pipe or device, which is read here and now. */
+static bool open_read_slot(const string& path, ReadSlot& slot) {
+    slot.fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat info;
+    if (slot.fd < 0 || fstat(slot.fd, &info) != 0) {
+        if (slot.fd >= 0)
+            close(slot.fd);
+        slot.finished = true;
+        return false;
+    }
+    if (!S_ISREG(info.st_mode) || info.st_size == 0) {
+        if (!S_ISREG(info.st_mode))
+            slot.data = read_all(slot.fd);
+        close(slot.fd);
+        slot.finished = true;
+        slot.ok = true;
+        return false;
+    }
+    slot.data.resize((size_t)info.st_size);
+    return true;
+}
+
+/* Marks slot done, keeping what was read. A file that shrank since it was opened ends early. */
+static void finish_read_slot(ReadSlot& slot, bool ok) {
+    close(slot.fd);
+    slot.data.resize(slot.done);
+    slot.finished = true;
+    slot.ok = ok;
+}
+
+/* io_uring without liburing: the rings are mapped from the ring's file descriptor, entries are
+   filled in directly, and io_uring_enter submits them and waits for completions. */
+class UringIO : public BatchIO {
+public:
+    ~UringIO() override;
+    bool setup(unsigned num_entries);
+    int submit_read(const string& path) override;
+    bool take_read(int ticket, string& contents) override;
+    void submit_write(int fd, string data, bool close_fd) override;
+    void drain() override;
+    const char* name() const override { return "io_uring"; }
+
+private:
+    int ring_fd = -1;
+    unsigned entries = 0;
+    unsigned in_flight = 0;
+    void* sq_ring = MAP_FAILED;
+    void* cq_ring = MAP_FAILED;
+    size_t sq_ring_size = 0;
+    size_t cq_ring_size = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    unsigned* sq_tail;
+    unsigned sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned cq_mask;
+    io_uring_cqe* cqes;
+
+    std::deque<ReadSlot> reads;
+    std::deque<int> queued_reads;      // Tickets with bytes left and no request in flight.
+    std::deque<PendingWrite> writes;   // Only the first one is ever in flight.
+    bool write_in_flight = false;
+
+    void submit_queued();
+    void take_back(unsigned count);
+    void run_blocking();
+    void reap(bool wait);
+    void complete(uint64_t user_data, int result);
+};
+
+/* Completion tags: a read's ticket shifted left, or 1 for the write in flight. */
+static const uint64_t WRITE_TAG = 1;
+
+/* ************************************************ */
+static int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+/* ************************************************ */
+bool UringIO::setup(unsigned num_entries) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd = (int)syscall(__NR_io_uring_setup, num_entries, &params);
+    if (ring_fd < 0)
+        return false;
+    // Reads and writes at the current file position came with IORING_OP_READ and IORING_OP_WRITE.
+    if (!(params.features & IORING_FEAT_RW_CUR_POS))
+        return false;
+    entries = params.sq_entries;
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap)
+        sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+    sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED)
+        return false;
+    cq_ring = single_mmap ? sq_ring : mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED)
+        return false;
+    void* sqes_memory = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (sqes_memory == MAP_FAILED)
+        return false;
+    sqes = static_cast<io_uring_sqe*>(sqes_memory);
+    char* sq = static_cast<char*>(sq_ring);
+    char* cq = static_cast<char*>(cq_ring);
+    sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+}
+
+/* ************************************************ */
+UringIO::~UringIO() {
+    if (sqes != MAP_FAILED)
+        munmap(sqes, entries * sizeof(io_uring_sqe));
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring)
+        munmap(cq_ring, cq_ring_size);
+    if (sq_ring != MAP_FAILED)
+        munmap(sq_ring, sq_ring_size);
+    if (ring_fd >= 0)
+        close(ring_fd);
+}
+
+/* ************************************************ */
+int UringIO::submit_read(const string& path) {
+    int ticket = (int)reads.size();
+    reads.emplace_back();
+    if (open_read_slot(path, reads.back())) {
+        queued_reads.push_back(ticket);
+        submit_queued();
+    }
+    return ticket;
+}
+
+/* ************************************************ */
+bool UringIO::take_read(int ticket, string& contents) {
+    ReadSlot& slot = reads[ticket];
+    while (!slot.finished)
+        reap(true);
+    contents = std::move(slot.data);
+    slot.data = string();
+    return slot.ok;
+}
+
+/* ************************************************ */
+void UringIO::submit_write(int fd, string data, bool close_fd) {
+    if (data.empty() && !close_fd)
+        return;
+    writes.push_back({ fd, std::move(data), close_fd });
+    // Completions are collected on the way, without waiting, so the ring keeps moving.
+    reap(false);
+    submit_queued();
+}
+
+/* ************************************************ */
+void UringIO::drain() {
+    while (!writes.empty())
+        reap(true);
+}
+
+/* Fills free entries, the pending write first, and hands them to the kernel with one syscall. */
+void UringIO::submit_queued() {
+    unsigned tail = *sq_tail; // Only this thread moves the tail.
+    unsigned added = 0;
+    while (in_flight + added < entries) {
+        io_uring_sqe* sqe = &sqes[tail & sq_mask];
+        memset(sqe, 0, sizeof(*sqe));
+        if (!write_in_flight && !writes.empty()) {
+            const PendingWrite& write = writes.front();
+            sqe->opcode = IORING_OP_WRITE;
+            sqe->fd = write.fd;
+            sqe->addr = (uint64_t)(uintptr_t)(write.data.data() + write.done);
+            sqe->len = (unsigned)std::min(write.data.size() - write.done, (size_t)1 << 30);
+            sqe->off = (uint64_t)-1; // At the descriptor's position, as write(2) would.
+            sqe->user_data = WRITE_TAG;
+            write_in_flight = true;
+        } else if (!queued_reads.empty()) {
+            int ticket = queued_reads.front();
+            queued_reads.pop_front();
+            ReadSlot& slot = reads[ticket];
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = slot.fd;
+            sqe->addr = (uint64_t)(uintptr_t)(&slot.data[0] + slot.done);
+            sqe->len = (unsigned)std::min(slot.data.size() - slot.done, (size_t)1 << 30);
+            sqe->off = slot.done;
+            sqe->user_data = (uint64_t)ticket << 1;
+        } else {
+            break;
+        }
+        sq_array[tail & sq_mask] = tail & sq_mask;
+        tail++;
+        added++;
+    }
+    if (added == 0)
+        return;
+    __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+    unsigned accepted = 0;
+    while (accepted < added) {
+        int submitted = io_uring_enter(ring_fd, added - accepted, 0, 0);
+        if (submitted < 0 && errno == EINTR)
+            continue;
+        if (submitted <= 0)
+            break;
+        accepted += submitted;
+    }
+    in_flight += accepted;
+    if (accepted == added)
+        return;
+    // The kernel takes entries in order, so the ones it refused are the last ones added.
+    take_back(added - accepted);
+    // Completions free whatever it ran short of; with none to come, the queues move without it.
+    if (in_flight == 0)
+        run_blocking();
+}
+
+/* Removes the last count entries from the ring and queues their requests again. */
+void UringIO::take_back(unsigned count) {
+    unsigned tail = *sq_tail;
+    for (unsigned i = 0; i < count; i++) {
+        tail--;
+        uint64_t user_data = sqes[tail & sq_mask].user_data;
+        if (user_data == WRITE_TAG)
+            write_in_flight = false;
+        else
+            queued_reads.push_front((int)(user_data >> 1));
+    }
+    __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+}
+
+/* Does the next request with a blocking call, for when the ring takes nothing. */
+void UringIO::run_blocking() {
+    if (!writes.empty()) {
+        const PendingWrite& write = writes.front();
+        ssize_t n = ::write(write.fd, write.data.data() + write.done, std::min(write.data.size() - write.done, (size_t)1 << 30));
+        write_in_flight = true;
+        complete(WRITE_TAG, n < 0 ? -errno : (int)n);
+    } else if (!queued_reads.empty()) {
+        int ticket = queued_reads.front();
+        queued_reads.pop_front();
+        ReadSlot& slot = reads[ticket];
+        ssize_t n = pread(slot.fd, &slot.data[slot.done], std::min(slot.data.size() - slot.done, (size_t)1 << 30), (off_t)slot.done);
+        complete((uint64_t)ticket << 1, n < 0 ? -errno : (int)n);
+    }
+}
+
+/* Handles every completion that has arrived, first waiting for one if asked to and any are due. */
+void UringIO::reap(bool wait) {
+    if (wait && in_flight > 0 && __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE) == *cq_head) {
+        while (io_uring_enter(ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno == EINTR) {}
+    }
+    unsigned head = *cq_head;
+    unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const io_uring_cqe& cqe = cqes[head & cq_mask];
+        uint64_t user_data = cqe.user_data;
+        int result = cqe.res;
+        head++;
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        in_flight--;
+        complete(user_data, result);
+    }
+    submit_queued();
+}
+
+/* ************************************************ */
+void UringIO::complete(uint64_t user_data, int result) {
+    bool retry = result == -EINTR || result == -EAGAIN;
+    if (user_data == WRITE_TAG) {
+        write_in_flight = false;
+        PendingWrite& write = writes.front();
+        if (retry)
+            return;
+        // Nothing to be done about a closed pipe or a full disk; the rest is dropped.
+        if (result <= 0)
+            write.done = write.data.size();
+        else
+            write.done += result;
+        if (write.done == write.data.size()) {
+            finish_write(write);
+            writes.pop_front();
+        }
+        return;
+    }
+    int ticket = (int)(user_data >> 1);
+    ReadSlot& slot = reads[ticket];
+    if (retry) {
+        queued_reads.push_front(ticket);
+        return;
+    }
+    if (result <= 0) {
+        finish_read_slot(slot, result == 0);
+        return;
+    }
+    slot.done += result;
+    if (slot.done == slot.data.size())
+        finish_read_slot(slot, true);
+    else
+        queued_reads.push_front(ticket);
+}
+
+/* The fallback: a few threads take reads and writes off shared queues. One write runs at a time,
+   which keeps writes in order. */
+class ThreadIO : public BatchIO {
+public:
+    explicit ThreadIO(int num_threads) : num_threads(num_threads) {}
+    ~ThreadIO() override;
+    int submit_read(const string& path) override;
+    bool take_read(int ticket, string& contents) override;
+    void submit_write(int fd, string data, bool close_fd) override;
+    void drain() override;
+    const char* name() const override { return "threads"; }
+
+private:
+    int num_threads;
+    std::vector<std::thread> threads; // Started with the first request.
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<ReadSlot> reads;
+    std::deque<int> queued_reads;
+    std::deque<PendingWrite> writes;
+    bool writing = false;
+    bool stopping = false;
+
+    void start();
+    void run();
+};
+
+/* ************************************************ */
+ThreadIO::~ThreadIO() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    for (auto& thread : threads)
+        thread.join();
+}
+
+/* ************************************************ */
+void ThreadIO::start() {
+    if (threads.empty()) {
+        for (int i = 0; i < num_threads; i++)
+            threads.emplace_back(&ThreadIO::run, this);
+    }
+}
+
+/* ************************************************ */
+int ThreadIO::submit_read(const string& path) {
+    std::unique_lock<std::mutex> lock(mutex);
+    int ticket = (int)reads.size();
+    reads.emplace_back();
+    ReadSlot& slot = reads.back();
+    lock.unlock();
+    // Opening is quick, and the slot is not queued yet, so no thread touches it meanwhile.
+    bool pending = open_read_slot(path, slot);
+    lock.lock();
+    if (pending) {
+        start();
+        queued_reads.push_back(ticket);
+        changed.notify_all();
+    }
+    return ticket;
+}
+
+/* ************************************************ */
+bool ThreadIO::take_read(int ticket, string& contents) {
+    std::unique_lock<std::mutex> lock(mutex);
+    ReadSlot& slot = reads[ticket];
+    changed.wait(lock, [&] { return slot.finished; });
+    contents = std::move(slot.data);
+    slot.data = string();
+    return slot.ok;
+}
+
+/* ************************************************ */
+void ThreadIO::submit_write(int fd, string data, bool close_fd) {
+    if (data.empty() && !close_fd)
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    start();
+    writes.push_back({ fd, std::move(data), close_fd });
+    changed.notify_all();
+}
+
+/* ************************************************ */
+void ThreadIO::drain() {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return writes.empty(); });
+}
+
+/* ************************************************ */
+void ThreadIO::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        changed.wait(lock, [&] { return stopping || !queued_reads.empty() || (!writing && !writes.empty()); });
+        if (stopping)
+            return;
+        if (!writing && !writes.empty()) {
+            writing = true;
+            PendingWrite& write = writes.front();
+            lock.unlock();
+            while (write.done < write.data.size()) {
+                ssize_t n = ::write(write.fd, write.data.data() + write.done, write.data.size() - write.done);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    break;
+                write.done += n;
+            }
+            finish_write(write);
+            lock.lock();
+            writes.pop_front();
+            writing = false;
+        } else {
+            ReadSlot& slot = reads[queued_reads.front()];
+            queued_reads.pop_front();
+            lock.unlock();
+            bool ok = true;
+            while (slot.done < slot.data.size()) {
+                ssize_t n = pread(slot.fd, &slot.data[slot.done], slot.data.size() - slot.done, (off_t)slot.done);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0) {
+                    ok = n == 0;
+                    break;
+                }
+                slot.done += n;
+            }
+            lock.lock();
+            finish_read_slot(slot, ok);
+        }
+        changed.notify_all();
+    }
+}
+
+/* ************************************************ */
+BatchIO* open_batch_io() {
+    UringIO* uring = new UringIO();
+    if (uring->setup(64))
+        return uring;
+    delete uring;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return new ThreadIO((int)std::min(std::max(cpus, 1L), 4L));
+}
@@ -0,0 +1,28 @@
+#ifndef COMPIHW3_BATCHIO_H
+#define COMPIHW3_BATCHIO_H
+
+#include <string>
+
+/* Reads of whole files and writes to file descriptors that are submitted now and finish in the
+   background, so the I/O of one input overlaps the analysis of another.
+
+   Reads are queued ahead: submit_read starts one and returns a ticket, and take_read waits for it.
+   Writes finish in the order they were submitted; a failed write, such as one to a closed pipe, is
+   dropped like the rest of the output would be. With close_fd, fd is closed after the write. */
+class BatchIO {
+public:
+    virtual ~BatchIO() = default;
+    virtual int submit_read(const std::string& path) = 0;
+    /* Moves the file's bytes into contents. False if it could not be opened or read. */
+    virtual bool take_read(int ticket, std::string& contents) = 0;
+    virtual void submit_write(int fd, std::string data, bool close_fd) = 0;
+    /* Waits until every submitted write is done. */
+    virtual void drain() = 0;
+    virtual const char* name() const = 0;
+};
+
+/* io_uring, set up through raw syscalls, when the kernel has it and allows it; otherwise a few
+   threads doing blocking pread and write. Never null. */
+BatchIO* open_batch_io();
+
+#endif //COMPIHW3_BATCHIO_H
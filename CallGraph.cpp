@@ -0,0 +1,226 @@
+#include "CallGraph.h"
+#include "SemanticAnalyzer.h"
+#include <algorithm>
+#include <cmath>
+
+CallGraph call_graph;
+
+/* ************************************************ */
+void CallGraph::reserve(int num_functions) {
+    callees.reserve(num_functions);
+    call_weights.reserve(num_functions);
+    param_slots.reserve(num_functions);
+    local_slots.reserve(num_functions);
+    self_cost.reserve(num_functions);
+}
+
+/* ************************************************ */
+void CallGraph::clear() {
+    callees.clear();
+    call_weights.clear();
+    param_slots.clear();
+    local_slots.clear();
+    self_cost.clear();
+}
+
+/* ************************************************ */
+void CallGraph::add_function(int func_id, int num_params) {
+    if (func_id >= (int)callees.size()) {
+        callees.resize(func_id + 1);
+        call_weights.resize(func_id + 1);
+        param_slots.resize(func_id + 1);
+        local_slots.resize(func_id + 1);
+        self_cost.resize(func_id + 1);
+    }
+    param_slots[func_id] = num_params;
+}
+
+/* ************************************************ */
+void CallGraph::add_call(int caller, int callee, double weight) {
+    vector<int>& calls = callees[caller];
+    // Bodies call few distinct functions, a scan beats a set.
+    auto found = std::find(calls.begin(), calls.end(), callee);
+    if (found == calls.end()) {
+        calls.push_back(callee);
+        call_weights[caller].push_back(weight);
+    } else {
+        call_weights[caller][found - calls.begin()] += weight;
+    }
+}
+
+/* ************************************************ */
+void CallGraph::use_slot(int func_id, int offset) {
+    local_slots[func_id] = std::max(local_slots[func_id], offset + 1);
+}
+
+/* Node of the depth-first walk in analyze_call_graph. */
+class WalkFrame {
+public:
+    int func;
+    int next_callee;
+};
+
+/* ************************************************ */
+CallGraphReport analyze_call_graph(const CallGraph& graph, int main_id) {
+    const int n = (int)graph.callees.size();
+    CallGraphReport report;
+    report.reachable.assign(n, false);
+    report.max_depth.assign(n, 0);
+    report.cost.assign(n, 0);
+
+    if (main_id >= 0) {
+        vector<int> work = { main_id };
+        report.reachable[main_id] = true;
+        while (!work.empty()) {
+            int func = work.back();
+            work.pop_back();
+            for (int callee : graph.callees[func]) {
+                if (!report.reachable[callee]) {
+                    report.reachable[callee] = true;
+                    work.push_back(callee);
+                }
+            }
+        }
+    }
+
+    // Tarjan's algorithm with an explicit stack, so long call chains cannot overflow ours.
+    // A component is closed only after every component it calls, so callee depths are known by then.
+    vector<int> index(n, -1);
+    vector<int> low(n);
+    vector<bool> on_stack(n, false);
+    vector<int> open;
+    vector<WalkFrame> walk;
+    int next_index = 0;
+    auto visit = [&](int func) {
+        index[func] = low[func] = next_index++;
+        open.push_back(func);
+        on_stack[func] = true;
+        walk.push_back({ func, 0 });
+    };
+    for (int root = 0; root < n; root++) {
+        if (index[root] >= 0)
+            continue;
+        visit(root);
+        while (!walk.empty()) {
+            int func = walk.back().func;
+            if (walk.back().next_callee < (int)graph.callees[func].size()) {
+                int callee = graph.callees[func][walk.back().next_callee++];
+                if (index[callee] < 0)
+                    visit(callee);
+                else if (on_stack[callee])
+                    low[func] = std::min(low[func], index[callee]);
+                continue;
+            }
+            walk.pop_back();
+            if (!walk.empty())
+                low[walk.back().func] = std::min(low[walk.back().func], low[func]);
+            if (low[func] != index[func])
+                continue;
+
+            vector<int> members;
+            int member;
+            do {
+                member = open.back();
+                open.pop_back();
+                on_stack[member] = false;
+                members.push_back(member);
+            } while (member != func);
+            // Callees outside the component are closed, so their costs are final. Calls within it are
+            // not followed, and no member's cost is set until all are known, so the order of the
+            // members does not matter.
+            for (int m : members)
+                report.cost[m] = -1;
+            vector<double> costs;
+            for (int m : members) {
+                double cost = graph.self_cost[m];
+                for (size_t c = 0; c < graph.callees[m].size(); c++) {
+                    int callee = graph.callees[m][c];
+                    if (report.cost[callee] >= 0)
+                        cost += graph.call_weights[m][c] * report.cost[callee];
+                }
+                costs.push_back(cost);
+            }
+            for (size_t i = 0; i < members.size(); i++)
+                report.cost[members[i]] = costs[i];
+            const vector<int>& calls = graph.callees[func];
+            bool recursive = members.size() > 1 || std::find(calls.begin(), calls.end(), func) != calls.end();
+            if (recursive) {
+                std::sort(members.begin(), members.end());
+                for (int m : members)
+                    report.max_depth[m] = -1;
+                report.cycles.push_back(members);
+                continue;
+            }
+            int deepest_callee = 0;
+            for (int callee : calls) {
+                if (report.max_depth[callee] < 0) {
+                    deepest_callee = -1;
+                    break;
+                }
+                deepest_callee = std::max(deepest_callee, report.max_depth[callee]);
+            }
+            report.max_depth[func] = deepest_callee < 0 ? -1 : graph.frame_slots(func) + deepest_callee;
+        }
+    }
+    std::sort(report.cycles.begin(), report.cycles.end());
+    return report;
+}
+
+/* ************************************************ */
+void print_call_graph_report() {
+    int main_id = find_function("main");
+    CallGraphReport report = analyze_call_graph(call_graph, main_id);
+    std::cout << "---call graph---" << '\n';
+    if (main_id >= 0) {
+        // print and printi are built in; not calling them is not dead code.
+        for (int func = 2; func < (int)report.reachable.size(); func++) {
+            if (!report.reachable[func])
+                std::cout << functions_table[func].name << " unreachable" << '\n';
+        }
+    }
+    for (const auto& cycle : report.cycles) {
+        vector<string> cycle_names;
+        for (int func : cycle)
+            cycle_names.push_back(functions_table[func].name);
+        std::cout << output::typeListToString(cycle_names) << " recursive" << '\n';
+    }
+    for (int func = 0; func < (int)report.max_depth.size(); func++) {
+        std::cout << functions_table[func].name << " stack ";
+        if (report.max_depth[func] < 0)
+            std::cout << "unbounded" << '\n';
+        else
+            std::cout << report.max_depth[func] << '\n';
+    }
+}
+
+/* Exact while it fits; deep loop nests get an exponent. */
+static void print_cost(double cost) {
+    if (cost < 1e18)
+        std::cout << std::llround(cost);
+    else
+        std::cout << cost;
+}
+
+/* ************************************************ */
+void print_cost_report(int top) {
+    CallGraphReport report = analyze_call_graph(call_graph, find_function("main"));
+    vector<int> ranked;
+    for (int func = 2; func < (int)report.cost.size(); func++)
+        ranked.push_back(func);
+    std::stable_sort(ranked.begin(), ranked.end(), [&](int a, int b) { return report.cost[a] > report.cost[b]; });
+    if ((int)ranked.size() > top)
+        ranked.resize(top);
+    vector<bool> recursive(report.cost.size(), false);
+    for (const auto& cycle : report.cycles) {
+        for (int func : cycle)
+            recursive[func] = true;
+    }
+    std::cout << "---cost---" << '\n';
+    for (int func : ranked) {
+        std::cout << functions_table[func].name << " cost ";
+        print_cost(report.cost[func]);
+        std::cout << " self ";
+        print_cost(call_graph.self_cost[func]);
+        std::cout << (recursive[func] ? " recursive" : "") << '\n';
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef COMPIHW3_CALLGRAPH_H
+#define COMPIHW3_CALLGRAPH_H
+
+#include <vector>
+
+/* Calls and frame sizes recorded while the bodies are checked, indexed by function id. */
+class CallGraph {
+public:
+    std::vector<std::vector<int>> callees; // Distinct callees of each function, in order of first call.
+    std::vector<std::vector<double>> call_weights; // Summed weight of the calls to each of callees.
+    std::vector<int> param_slots;
+    std::vector<int> local_slots;          // Locals live at the deepest point of the body.
+    std::vector<double> self_cost;         // Summed weight of the function's own statements.
+    void reserve(int num_functions);
+    void clear();
+    void add_function(int func_id, int num_params);
+    // weight is the number of times the call or statement is assumed to run per call of its function.
+    void add_call(int caller, int callee, double weight);
+    void add_statement(int func_id, double weight) { self_cost[func_id] += weight; }
+    // A local was given offset in the frame of func_id.
+    void use_slot(int func_id, int offset);
+    int frame_slots(int func_id) const { return param_slots[func_id] + local_slots[func_id]; }
+};
+
+extern CallGraph call_graph;
+
+/* What analyze_call_graph found, indexed by function id. */
+class CallGraphReport {
+public:
+    std::vector<bool> reachable;          // Called, directly or not, from main (main included).
+    std::vector<std::vector<int>> cycles; // Sets of mutually recursive functions, in id order.
+    std::vector<int> max_depth;           // Slots of the deepest call chain starting here; -1 if it can recurse.
+    std::vector<double> cost;             // Weighted statements run per call, callees included.
+};
+
+/* main_id is -1 if there is no main; then nothing is reachable. */
+CallGraphReport analyze_call_graph(const CallGraph& graph, int main_id);
+
+/* Prints the report of the analyzed program after its scope dumps (--call-graph). */
+void print_call_graph_report();
+
+/* Static cost model (--cost-report): a statement inside n loops counts loop_trips^n, and a call adds
+   the callee's cost times the same weight. Calls within a set of mutually recursive functions are not
+   followed, so their costs are lower bounds. */
+constexpr double loop_trips = 10;
+
+/* Prints the top functions by cost, other than print and printi, after the scope dumps. */
+void print_cost_report(int top);
+
+#endif //COMPIHW3_CALLGRAPH_H
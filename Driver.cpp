@@ -0,0 +1,614 @@
+#include "Driver.h"
+#include "AnalysisCache.h"
+#include "BatchIO.h"
+#include "CallGraph.h"
+#include "FrameLayout.h"
+#include "FunctionBody.h"
+#include "Liveness.h"
+#include "OutputSink.h"
+#include "Prescan.h"
+#include "PureCalls.h"
+#include "RangeAnalysis.h"
+#include "SemanticAnalyzer.h"
+#include "SymbolDb.h"
+#include "TokenStream.h"
+#include "WorkerPool.h"
+#include "parser.tab.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace output;
+
+extern FILE* yyin; // Scanner input, defined in lex.yy.c.
+void yyrestart(FILE* input_file);
+
+Options options;
+
+/* A top-level function as a range of recorded tokens. */
+class FunctionSlice {
+public:
+    int begin;
+    int end;
+};
+
+/* ************************************************ */
+static bool is_type_token(int kind) {
+    return kind == INT || kind == BYTE || kind == BOOL;
+}
+
+/* ************************************************ */
+static TypeId type_of_token(int kind) {
+    if (kind == INT)
+        return TypeId::INT;
+    if (kind == BYTE)
+        return TypeId::BYTE;
+    if (kind == BOOL)
+        return TypeId::BOOL;
+    return TypeId::VOID;
+}
+
+/* Splits the token stream after every RBRACE that closes a top-level block. */
+static vector<FunctionSlice> split_functions(const vector<Token>& tokens, int num_functions) {
+    vector<FunctionSlice> slices;
+    slices.reserve(num_functions + 1);
+    int depth = 0;
+    int begin = 0;
+    for (int i = 0; i < (int)tokens.size(); i++) {
+        if (tokens[i].kind == LBRACE)
+            depth++;
+        else if (tokens[i].kind == RBRACE && --depth <= 0) {
+            slices.push_back({ begin, i + 1 });
+            begin = i + 1;
+            depth = 0;
+        }
+    }
+    if (begin < (int)tokens.size())
+        slices.push_back({ begin, (int)tokens.size() });
+    return slices;
+}
+
+/* Registers the signature in the header of a slice: RetType ID LPAREN Formals RPAREN LBRACE.
+   Returns false if the header does not have that shape; the parser will reject it. */
+static bool register_signature(const vector<Token>& tokens, const FunctionSlice& slice) {
+    int i = slice.begin;
+    auto kind_at = [&](int pos) { return pos < slice.end ? tokens[pos].kind : 0; };
+    if (kind_at(i) != VOID && !is_type_token(kind_at(i)))
+        return false;
+    TypeId ret_type = type_of_token(kind_at(i++));
+    if (kind_at(i) != ID)
+        return false;
+    const string& name = tokens[i++].value->token_value;
+    if (kind_at(i++) != LPAREN)
+        return false;
+    vector<TypeId> param_types;
+    vector<bool> const_params;
+    if (kind_at(i) != RPAREN) {
+        while (true) {
+            bool is_const = kind_at(i) == CONST;
+            if (is_const)
+                i++;
+            if (!is_type_token(kind_at(i)) || kind_at(i + 1) != ID)
+                return false;
+            param_types.push_back(type_of_token(kind_at(i)));
+            const_params.push_back(is_const);
+            i += 2;
+            if (kind_at(i) != COMMA)
+                break;
+            i++;
+        }
+    }
+    if (kind_at(i++) != RPAREN || kind_at(i) != LBRACE)
+        return false;
+    register_function(name, ret_type, param_types, const_params);
+    return true;
+}
+
+/* Everything the check of a slice depends on: its tokens, with lines relative to its first one, and
+   the signature each identifier in it resolves to among the functions declared before it. */
+static uint64_t slice_key(const vector<Token>& tokens, const FunctionSlice& slice) {
+    KeyHasher key;
+    int base_lineno = tokens[slice.begin].lineno;
+    key.add(constant_checks);
+    key.add((int)layout_mode);
+    key.add(liveness_enabled);
+    key.add((int)options.format);
+    // Warnings on constant conditions name their line, without failing the check.
+    if (constant_checks)
+        key.add(base_lineno);
+    for (int i = slice.begin; i < slice.end; i++) {
+        const Token& token = tokens[i];
+        key.add(token.kind);
+        key.add(token.lineno - base_lineno);
+        if (token.kind == LEX_ERROR)
+            continue;
+        key.add(token.value->token_value);
+        if (token.kind == ID) {
+            int func_id = find_function(token.value->token_value);
+            key.add(func_id < 0 ? string() : *functions_table[func_id].type_string);
+        }
+    }
+    return key.value;
+}
+
+/* Two-phase analysis. The signature pass registers every function in declaration order; then the
+   bodies are checked independently, each seeing the functions declared before it, and the outputs
+   are printed in source order up to and including the first error, exactly as a single pass would. */
+static int run_two_phase(const InputProfile& profile) {
+    TokenStream stream;
+    stream.tokens.reserve(profile.tokens);
+    stream.lex_all();
+    vector<FunctionSlice> slices = split_functions(stream.tokens, profile.functions);
+
+    create_global_scope();
+    const int first_id = (int)functions_table.size();
+    // Nothing after a malformed header matters: its slice fails with a syntax error at the latest.
+    int num_jobs = 0;
+    while (num_jobs < (int)slices.size() && register_signature(stream.tokens, slices[num_jobs]))
+        num_jobs++;
+    if (num_jobs < (int)slices.size())
+        num_jobs++;
+
+    // With a cache, only the slices it has no result for are checked.
+    AnalysisCache cache;
+    vector<uint64_t> keys(num_jobs);
+    vector<const CacheEntry*> cached(num_jobs, nullptr);
+    vector<int> to_check;
+    auto eof_lineno_of = [&](const FunctionSlice& slice) {
+        return slice.end < (int)stream.tokens.size() ? stream.tokens[slice.end].lineno : stream.eof_lineno;
+    };
+    if (!options.cache_path.empty()) {
+        cache.load(options.cache_path);
+        int first_failed = num_jobs;
+        for (int j = 0; j < num_jobs; j++) {
+            const FunctionSlice& slice = slices[j];
+            visible_functions = first_id + j;
+            keys[j] = slice_key(stream.tokens, slice);
+            cached[j] = cache.lookup(keys[j], stream.tokens[slice.begin].lineno, eof_lineno_of(slice));
+            if (cached[j] && cached[j]->failed && j < first_failed)
+                first_failed = j;
+        }
+        // Nothing after the first failure is printed; those slices keep their entries unchecked.
+        for (int j = 0; j < first_failed; j++) {
+            if (cached[j])
+                stats.cache_hits++;
+            else
+                to_check.push_back(j);
+        }
+        // The failure itself is printed from its entry.
+        if (first_failed < num_jobs)
+            stats.cache_hits++;
+        stats.cache_misses = (int)to_check.size();
+    } else {
+        for (int j = 0; j < num_jobs; j++)
+            to_check.push_back(j);
+    }
+
+    checking_slices = true;
+    throw_on_error = true;
+    auto check_body = [&](int job) {
+        int j = to_check[job];
+        JobResult result;
+        std::stringbuf captured;
+        std::streambuf* saved = std::cout.rdbuf(&captured);
+        const FunctionSlice& slice = slices[j];
+        int eof_lineno = eof_lineno_of(slice);
+        begin_function_slice(first_id + j);
+        replay_tokens(stream.tokens.data() + slice.begin, stream.tokens.data() + slice.end, eof_lineno);
+        try {
+            yyparse();
+        } catch (const AnalysisAborted&) {
+            result.failed = true;
+        }
+        stop_replay();
+        std::cout.rdbuf(saved);
+        result.done = true;
+        result.output = captured.str();
+        return result;
+    };
+    int workers = options.workers > 0 ? options.workers : default_num_workers();
+    vector<JobResult> results = run_jobs((int)to_check.size(), workers, check_body);
+
+    // Print in source order up to the first failure, taking each slice from the cache or from its check.
+    bool failed = false;
+    const string* rejected = nullptr;
+    for (int j = 0, next_checked = 0; j < num_jobs && !failed; j++) {
+        const string* output;
+        if (cached[j]) {
+            output = &cached[j]->output;
+            failed = cached[j]->failed;
+        } else {
+            const JobResult& result = results[next_checked++];
+            if (!result.done)
+                break;
+            output = &result.output;
+            failed = result.failed;
+            if (!options.cache_path.empty()) {
+                const FunctionSlice& slice = slices[j];
+                cache.store(keys[j], { stream.tokens[slice.begin].lineno, eof_lineno_of(slice), result.failed, result.output });
+            }
+        }
+        // A single pass ends Program before a token that cannot start a function, so the main check
+        // is reported before that token's syntax error.
+        int first_kind = stream.tokens[slices[j].begin].kind;
+        if (failed && first_kind != VOID && !is_type_token(first_kind) && first_kind != LEX_ERROR)
+            rejected = output;
+        else
+            std::cout << *output;
+    }
+    if (!options.cache_path.empty() && !cache.save(options.cache_path))
+        std::cerr << "cannot write cache " << options.cache_path << std::endl;
+    if (failed && !rejected) {
+        std::cout.flush();
+        return 0;
+    }
+
+    checking_slices = false;
+    throw_on_error = false;
+    visible_functions = (int)functions_table.size();
+    check_for_main_correctness();
+    if (rejected)
+        std::cout << *rejected;
+    return 0;
+}
+
+/* Settings of the analysis from the options, the same for every input. */
+static void configure_analysis() {
+    setFormat(options.format);
+    if (options.stats)
+        atexit(print_stats);
+    if (options.all_errors)
+        collect_diagnostics(options.max_errors);
+    constant_checks = options.const_checks;
+    eval_calls = options.eval_calls;
+    if (eval_calls)
+        body_ir_enabled = true;
+    layout_mode = options.packed_frames ? LayoutMode::PACKED : LayoutMode::SLOTS;
+    liveness_enabled = options.liveness;
+}
+
+/* Analyzes one input of a batch, with its output going to std::cout. False if it had an error. */
+static bool analyze_input(string& input) {
+    reset_analysis();
+    reserve_tables(prescan(input.data(), input.size()));
+    FILE* file = input.empty() ? fopen("/dev/null", "r") : fmemopen(&input[0], input.size(), "r");
+    yyrestart(file);
+    yylineno = 1;
+    bool failed;
+    try {
+        failed = yyparse() != 0;
+        if (!failed && options.call_graph)
+            print_call_graph_report();
+        if (!failed && options.cost_report > 0)
+            print_cost_report(options.cost_report);
+    } catch (const AnalysisAborted&) {
+        failed = true;
+    }
+    fclose(file);
+    return !failed && errors_recorded == 0;
+}
+
+/* dir/name.in -> dir/name.ext */
+static string output_path_of(const string& input_path, const string& ext) {
+    size_t dot = input_path.rfind('.');
+    size_t slash = input_path.rfind('/');
+    if (dot == string::npos || (slash != string::npos && dot < slash))
+        dot = input_path.size();
+    return input_path.substr(0, dot) + "." + ext;
+}
+
+/* Analyzes one input of a batch and returns its exit status, 0 or 1. output gets what it printed,
+   behind a header when the outputs all go to stdout. */
+static int analyze_batch_input(const string& path, string& input, string& output) {
+    static std::stringbuf captured;
+    captured.str(string());
+    std::streambuf* saved = std::cout.rdbuf(&captured);
+    string header;
+    if (options.out_ext.empty())
+        appendFileHeader(header, path);
+    else if (options.format == OutputFormat::BIN)
+        header = binary_magic;
+    std::cout << header;
+    bool passed = analyze_input(input);
+    std::cout.rdbuf(saved);
+    output = captured.str();
+    return passed ? 0 : 1;
+}
+
+/* Inputs of the batch in the order they are analyzed by the pool: the largest first, so that no
+   large input starts last and holds up the end of the run. */
+static vector<int> largest_first(const vector<string>& paths) {
+    vector<off_t> sizes(paths.size(), 0);
+    for (size_t i = 0; i < paths.size(); i++) {
+        struct stat info;
+        if (stat(paths[i].c_str(), &info) == 0)
+            sizes[i] = info.st_size;
+    }
+    vector<int> order(paths.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = (int)i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return sizes[a] > sizes[b]; });
+    return order;
+}
+
+/* Batch mode: every input is analyzed in this process or its workers, with the scanner and the
+   analyzer reset in between, and the outputs are written in input order: each to a file of its own
+   with --out-ext, or else to stdout after a header. Returns 0 if every input passed, 1 if one had an
+   error, 2 if one could not be read or written.
+
+   With one worker the inputs are taken in order; the next ones are read while one is analyzed, and
+   each output is written in the background. With more, the worker pool takes them largest first and
+   their outputs are written once all are done. The pool is not a work-stealing one of threads: the
+   scanner, the parser and the analyzer keep their state in globals, so its workers are forked
+   processes that claim inputs from one shared counter. With the largest inputs claimed first, that
+   counter evens out the load as well as stealing would. */
+static int run_batch(const char* program, const vector<string>& paths) {
+    throw_on_error = true;
+    bool to_stdout = options.out_ext.empty();
+    int workers = options.workers > 0 ? options.workers : default_num_workers();
+    workers = std::min(workers, (int)paths.size());
+    vector<JobResult> results;
+    if (workers > 1) {
+        vector<int> order = largest_first(paths);
+        auto check_input = [&](int job) {
+            const string& path = paths[order[job]];
+            JobResult result;
+            result.done = true;
+            int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                std::cerr << program << ": cannot read " << path << std::endl;
+                result.status = 2;
+                return result;
+            }
+            string input = read_all(fd);
+            close(fd);
+            result.status = analyze_batch_input(path, input, result.output);
+            return result;
+        };
+        vector<JobResult> by_job = run_jobs((int)paths.size(), workers, check_input);
+        results.resize(paths.size());
+        for (size_t job = 0; job < order.size(); job++)
+            results[order[job]] = std::move(by_job[job]);
+    }
+    // Opened after the workers are gone: the thread fallback's threads would not survive a fork.
+    BatchIO* io = open_batch_io();
+
+    const size_t read_ahead = 16;
+    vector<int> tickets(workers > 1 ? 0 : paths.size());
+    size_t next_read = 0;
+    int status = 0;
+    if (to_stdout && options.format == OutputFormat::BIN)
+        io->submit_write(STDOUT_FILENO, binary_magic, false);
+    for (size_t i = 0; i < paths.size(); i++) {
+        JobResult result;
+        if (workers > 1) {
+            result = std::move(results[i]);
+            if (!result.done)
+                result.status = 2;
+        } else {
+            for (; next_read < paths.size() && next_read <= i + read_ahead; next_read++)
+                tickets[next_read] = io->submit_read(paths[next_read]);
+            string input;
+            if (io->take_read(tickets[i], input)) {
+                result.status = analyze_batch_input(paths[i], input, result.output);
+            } else {
+                std::cerr << program << ": cannot read " << paths[i] << std::endl;
+                result.status = 2;
+            }
+        }
+        status = std::max(status, result.status);
+        if (result.status == 2)
+            continue;
+        int out_fd = STDOUT_FILENO;
+        if (!to_stdout) {
+            string out_path = output_path_of(paths[i], options.out_ext);
+            out_fd = open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (out_fd < 0) {
+                std::cerr << program << ": cannot write " << out_path << std::endl;
+                status = 2;
+                continue;
+            }
+        }
+        io->submit_write(out_fd, std::move(result.output), !to_stdout);
+    }
+    io->drain();
+    return status;
+}
+
+/* Paths listed in a manifest, one per line; blank lines and lines starting with # are skipped. */
+static bool read_manifest(const string& path, vector<string>& paths) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    string text = read_all(fd);
+    close(fd);
+    std::istringstream lines(text);
+    string line;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty() && line[0] != '#')
+            paths.push_back(line);
+    }
+    return true;
+}
+
+/* ************************************************ */
+static int usage(const char* program) {
+    std::cerr << "usage: " << program << " [--stats] [--parallel-bodies] [-jN] [--all-errors] [--max-errors=N] [--const-checks] [--call-graph] [--cost-report[=N]] [--cache=FILE] [--frame-layout=slots|packed] [--liveness] [--ranges=FILE] [--eval-calls] [--symbol-db=FILE] [--format=text|jsonl|bin] [--line-buffered] < program\n"
+              << "       " << program << " [options] [--manifest=FILE] [--out-ext=EXT] FILE..." << std::endl;
+    return 1;
+}
+
+/* Parses a count given to an option: a positive decimal number and nothing else. */
+static bool parse_count(const char* text, int& count) {
+    char* end;
+    errno = 0;
+    long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || value < 1 || value > INT_MAX)
+        return false;
+    count = (int)value;
+    return true;
+}
+
+/* ************************************************ */
+int run_analyzer(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0)
+            options.stats = true;
+        else if (strcmp(argv[i], "--parallel-bodies") == 0)
+            options.parallel_bodies = true;
+        else if (strncmp(argv[i], "-j", 2) == 0) {
+            if (!parse_count(argv[i] + 2, options.workers))
+                return usage(argv[0]);
+        }
+        else if (strcmp(argv[i], "--all-errors") == 0)
+            options.all_errors = true;
+        else if (strncmp(argv[i], "--max-errors=", 13) == 0) {
+            if (!parse_count(argv[i] + 13, options.max_errors))
+                return usage(argv[0]);
+        }
+        else if (strcmp(argv[i], "--const-checks") == 0)
+            options.const_checks = true;
+        else if (strcmp(argv[i], "--call-graph") == 0)
+            options.call_graph = true;
+        else if (strcmp(argv[i], "--cost-report") == 0)
+            options.cost_report = 10;
+        else if (strncmp(argv[i], "--cost-report=", 14) == 0) {
+            if (!parse_count(argv[i] + 14, options.cost_report))
+                return usage(argv[0]);
+        }
+        else if (strcmp(argv[i], "--frame-layout=packed") == 0)
+            options.packed_frames = true;
+        else if (strcmp(argv[i], "--frame-layout=slots") == 0)
+            options.packed_frames = false;
+        else if (strcmp(argv[i], "--liveness") == 0)
+            options.liveness = true;
+        else if (strcmp(argv[i], "--line-buffered") == 0)
+            options.line_buffered = true;
+        else if (strncmp(argv[i], "--cache=", 8) == 0) {
+            options.cache_path = argv[i] + 8;
+            options.parallel_bodies = true;
+        }
+        else if (strcmp(argv[i], "--eval-calls") == 0)
+            options.eval_calls = true;
+        else if (strncmp(argv[i], "--ranges=", 9) == 0)
+            options.ranges_path = argv[i] + 9;
+        else if (strncmp(argv[i], "--symbol-db=", 12) == 0)
+            options.symbol_db_path = argv[i] + 12;
+        else if (strncmp(argv[i], "--manifest=", 11) == 0)
+            options.manifest_path = argv[i] + 11;
+        else if (strncmp(argv[i], "--out-ext=", 10) == 0 && argv[i][10] != '\0')
+            options.out_ext = argv[i] + 10;
+        else if (argv[i][0] != '-')
+            options.inputs.push_back(argv[i]);
+        else if (strcmp(argv[i], "--format=text") == 0)
+            options.format = OutputFormat::TEXT;
+        else if (strcmp(argv[i], "--format=jsonl") == 0)
+            options.format = OutputFormat::JSONL;
+        else if (strcmp(argv[i], "--format=bin") == 0)
+            options.format = OutputFormat::BIN;
+        else
+            return usage(argv[0]);
+    }
+    // Slices are merged up to the first failing one, which does not fit recovering from errors.
+    if (options.all_errors && options.parallel_bodies) {
+        std::cerr << argv[0] << ": --all-errors cannot be combined with --parallel-bodies" << std::endl;
+        return 1;
+    }
+    // Calls are recorded by the workers, which do not send them back.
+    if (options.call_graph && options.parallel_bodies) {
+        std::cerr << argv[0] << ": --call-graph cannot be combined with --parallel-bodies" << std::endl;
+        return 1;
+    }
+    if (options.cost_report > 0 && options.parallel_bodies) {
+        std::cerr << argv[0] << ": --cost-report cannot be combined with --parallel-bodies" << std::endl;
+        return 1;
+    }
+    // Likewise for the bodies kept for range analysis.
+    if (!options.ranges_path.empty() && options.parallel_bodies) {
+        std::cerr << argv[0] << ": --ranges cannot be combined with --parallel-bodies" << std::endl;
+        return 1;
+    }
+    // A worker does not see the bodies of the functions before its slice.
+    if (options.eval_calls && options.parallel_bodies) {
+        std::cerr << argv[0] << ": --eval-calls cannot be combined with --parallel-bodies" << std::endl;
+        return 1;
+    }
+    // Like the call graph it includes.
+    if (!options.symbol_db_path.empty() && options.parallel_bodies) {
+        std::cerr << argv[0] << ": --symbol-db cannot be combined with --parallel-bodies" << std::endl;
+        return 1;
+    }
+    if (!options.manifest_path.empty() && !read_manifest(options.manifest_path, options.inputs)) {
+        std::cerr << argv[0] << ": cannot read " << options.manifest_path << std::endl;
+        return 1;
+    }
+    bool batch = !options.inputs.empty() || !options.manifest_path.empty();
+    // These read stdin, or write one file for the whole run.
+    if (batch && (options.parallel_bodies || !options.ranges_path.empty() || !options.symbol_db_path.empty())) {
+        std::cerr << argv[0] << ": --parallel-bodies, --cache, --ranges and --symbol-db take the program on stdin" << std::endl;
+        return 1;
+    }
+    // The reports are tables for a reader, with no structured form.
+    if (options.format != OutputFormat::TEXT && (options.call_graph || options.cost_report > 0)) {
+        std::cerr << argv[0] << ": --call-graph and --cost-report need --format=text" << std::endl;
+        return 1;
+    }
+    // Static, so exit() on a semantic error still flushes what was written.
+    static std::ofstream ranges_file;
+    if (!options.ranges_path.empty()) {
+        ranges_file.open(options.ranges_path);
+        if (!ranges_file) {
+            std::cerr << argv[0] << ": cannot write " << options.ranges_path << std::endl;
+            return 1;
+        }
+        ranges_out = &ranges_file;
+        body_ir_enabled = true;
+    }
+    if (batch) {
+        configure_analysis();
+        return run_batch(argv[0], options.inputs);
+    }
+    // The whole input is read and sized up first, so the tables can be reserved before the parse.
+    static string input; // yyin reads from it until exit.
+    input = read_all(STDIN_FILENO);
+    InputProfile profile = prescan(input.data(), input.size());
+    if (!input.empty())
+        yyin = fmemopen(&input[0], input.size(), "r");
+    // Output reaches a file or pipe in large blocks, or a terminal line by line.
+    // Every declaration prints a line, so larger inputs get a larger buffer, up to 1 MiB.
+    size_t buffer_size = std::min(std::max(profile.tokens * 4, 1L << 16), 1L << 20);
+    bool line_mode = options.line_buffered || isatty(STDOUT_FILENO);
+    // Output that outgrows the buffer is written in the background while the analysis goes on, except
+    // with --parallel-bodies, which forks, and the thread fallback's threads would not survive that.
+    bool background = !line_mode && !options.parallel_bodies && profile.tokens * 4 > (long)buffer_size;
+    BatchIO* io = background ? open_batch_io() : nullptr;
+    install_output_sink(new FdSink(STDOUT_FILENO, buffer_size, line_mode, io));
+    if (options.format == OutputFormat::BIN)
+        std::cout.write(binary_magic, 4);
+    configure_analysis();
+    reserve_tables(profile);
+    if (!options.symbol_db_path.empty())
+        symbol_db = new SymbolDbBuilder();
+    if (options.parallel_bodies)
+        return run_two_phase(profile);
+    int result = yyparse();
+    if (result == 0 && options.call_graph)
+        print_call_graph_report();
+    if (result == 0 && options.cost_report > 0)
+        print_cost_report(options.cost_report);
+    if (result == 0 && symbol_db && !write_symbol_db(options.symbol_db_path)) {
+        std::cerr << argv[0] << ": cannot write " << options.symbol_db_path << std::endl;
+        return 1;
+    }
+    return result;
+}
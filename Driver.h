@@ -0,0 +1,37 @@
+#ifndef COMPIHW3_DRIVER_H
+#define COMPIHW3_DRIVER_H
+
+#include "hw3_output.hpp"
+#include <string>
+#include <vector>
+
+/* Command line options. */
+class Options {
+public:
+    bool stats = false;           // --stats: print analyzer counters to stderr.
+    bool parallel_bodies = false; // --parallel-bodies: two-phase analysis, bodies checked by a worker pool.
+    int workers = 0;              // -jN: worker count for --parallel-bodies and batches, 0 for one per CPU.
+    bool all_errors = false;      // --all-errors: report every semantic error instead of the first.
+    int max_errors = 50;          // --max-errors=N: errors printed by --all-errors.
+    bool const_checks = false;    // --const-checks: diagnostics on folded constant expressions.
+    bool call_graph = false;      // --call-graph: unreachable functions, recursion and stack depths.
+    int cost_report = 0;          // --cost-report[=N]: the N (10) functions with the highest static cost.
+    std::string cache_path;       // --cache=FILE: reuse body checks of earlier runs; implies --parallel-bodies.
+    bool packed_frames = false;   // --frame-layout=packed: byte offsets and frame sizes (default: slots).
+    bool line_buffered = false;   // --line-buffered: write every output line at once, as on a terminal.
+    bool liveness = false;        // --liveness: slots needed when locals that are never live together share.
+    bool eval_calls = false;      // --eval-calls: fold calls of pure functions; checked with --const-checks.
+    std::string ranges_path;      // --ranges=FILE: value ranges of arithmetic, as JSON lines.
+    std::string symbol_db_path;   // --symbol-db=FILE: scopes, symbols, signatures and calls, for mmap.
+    std::vector<std::string> inputs; // FILE...: batch mode, every file analyzed in this process.
+    std::string manifest_path;    // --manifest=FILE: more inputs, one path per line.
+    std::string out_ext;          // --out-ext=EXT: batch output of dir/name.in goes to dir/name.EXT.
+    output::OutputFormat format = output::OutputFormat::TEXT; // --format=text|jsonl|bin.
+};
+
+extern Options options;
+
+/* Entry point: parses the command line and analyzes stdin. */
+int run_analyzer(int argc, char* argv[]);
+
+#endif //COMPIHW3_DRIVER_H
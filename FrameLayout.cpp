@@ -0,0 +1,93 @@
+#include "FrameLayout.h"
+#include <algorithm>
+
+LayoutMode layout_mode = LayoutMode::SLOTS;
+
+// Parameters are pushed by the caller as 4 byte words below the frame.
+constexpr int param_size = 4;
+
+/* ************************************************ */
+static int size_of(TypeId type) {
+    return type == TypeId::INT ? 4 : 1;
+}
+
+/* ************************************************ */
+void FrameLayout::begin_function() {
+    scopes.clear();
+    variables.clear();
+    open.clear();
+    scopes.emplace_back();
+    open.push_back(0);
+}
+
+/* ************************************************ */
+void FrameLayout::open_scope() {
+    int scope = (int)scopes.size();
+    scopes.emplace_back();
+    scopes[open.back()].items.push_back({ true, scope });
+    open.push_back(scope);
+}
+
+/* ************************************************ */
+void FrameLayout::close_scope() {
+    open.pop_back();
+}
+
+/* ************************************************ */
+void FrameLayout::add_variable(TypeId type, bool is_param) {
+    int variable = (int)variables.size();
+    variables.push_back({ type, is_param, 0 });
+    ScopeNode& scope = scopes[open.back()];
+    scope.variables.push_back(variable);
+    if (!is_param)
+        scope.items.push_back({ false, variable });
+}
+
+/* Lays out scope from base; returns the end of the deepest point. */
+int FrameLayout::layout_scope(int scope, int base) {
+    const vector<Item>& items = scopes[scope].items;
+    int end = base;
+    int deepest = base;
+    size_t i = 0;
+    while (i < items.size()) {
+        if (items[i].is_scope) {
+            deepest = std::max(deepest, layout_scope(items[i].index, end));
+            i++;
+            continue;
+        }
+        // A run of declarations: wide ones first.
+        size_t run_end = i;
+        while (run_end < items.size() && !items[run_end].is_scope)
+            run_end++;
+        for (int width : { 4, 1 }) {
+            for (size_t j = i; j < run_end; j++) {
+                Variable& variable = variables[items[j].index];
+                if (size_of(variable.type) != width)
+                    continue;
+                end = (end + width - 1) / width * width;
+                variable.offset = end;
+                end += width;
+            }
+        }
+        deepest = std::max(deepest, end);
+        i = run_end;
+    }
+    return deepest;
+}
+
+/* ************************************************ */
+int FrameLayout::assign_offsets() {
+    int param_offset = 0;
+    for (int variable : scopes[0].variables) {
+        if (variables[variable].is_param) {
+            param_offset -= param_size;
+            variables[variable].offset = param_offset;
+        }
+    }
+    return layout_scope(0, 0);
+}
+
+/* ************************************************ */
+int FrameLayout::offset_of(int scope, int index) const {
+    return variables[scopes[scope].variables[index]].offset;
+}
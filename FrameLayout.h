@@ -0,0 +1,56 @@
+#ifndef COMPIHW3_FRAMELAYOUT_H
+#define COMPIHW3_FRAMELAYOUT_H
+
+#include "SemanticAnalyzer.h"
+
+/* How local variables are given offsets.
+   SLOTS:  one slot per variable, as printed by the course's printID format (the default).
+   PACKED: byte offsets; ints take 4 aligned bytes, bools and bytes one. */
+enum class LayoutMode {
+    SLOTS,
+    PACKED
+};
+
+extern LayoutMode layout_mode;
+
+/* The scope tree of one function, laid out once the function is complete.
+   Within a scope, the variables declared between two nested blocks form a run; a run starts where
+   the previous one ends, and so does the block after it, since nothing of the block is live once
+   it closes. Each run places its ints first so that the narrow variables do not cost padding. */
+class FrameLayout {
+public:
+    // Opens the function's outermost scope, dropping the previous function.
+    void begin_function();
+    void open_scope();
+    void close_scope();
+    int current_scope() const { return open.back(); }
+    void add_variable(TypeId type, bool is_param);
+    // Assigns the offsets; returns the frame size in bytes, parameters excluded.
+    int assign_offsets();
+    // Offset of the index-th variable declared in scope (parameters first in the outermost scope).
+    int offset_of(int scope, int index) const;
+
+private:
+    class Variable {
+    public:
+        TypeId type;
+        bool is_param;
+        int offset;
+    };
+    class Item {
+    public:
+        bool is_scope;
+        int index; // In scopes or variables.
+    };
+    class ScopeNode {
+    public:
+        vector<Item> items;  // Declaration order, nested blocks included.
+        vector<int> variables;
+    };
+    vector<ScopeNode> scopes;
+    vector<Variable> variables;
+    vector<int> open;
+    int layout_scope(int scope, int base);
+};
+
+#endif //COMPIHW3_FRAMELAYOUT_H
@@ -0,0 +1,82 @@
+#include "FunctionBody.h"
+#include "PureCalls.h"
+#include "RangeAnalysis.h"
+
+bool body_ir_enabled;
+FunctionBody current_body;
+
+static vector<int> var_of_symbol;
+
+/* ************************************************ */
+int FunctionBody::add_exp(ExpOp op, TypeId type, int first, int second) {
+    ExpNode node;
+    node.op = op;
+    node.type = type;
+    node.lineno = yylineno;
+    node.first = first;
+    node.second = second;
+    exps.push_back(node);
+    return (int)exps.size() - 1;
+}
+
+/* ************************************************ */
+int FunctionBody::add_stmt(StmtOp op, int first, int second, int third) {
+    StmtNode node;
+    node.op = op;
+    node.lineno = yylineno;
+    node.first = first;
+    node.second = second;
+    node.third = third;
+    stmts.push_back(node);
+    return (int)stmts.size() - 1;
+}
+
+/* ************************************************ */
+int FunctionBody::add_block(const vector<int>& items) {
+    int first = (int)block_items.size();
+    block_items.insert(block_items.end(), items.begin(), items.end());
+    return add_stmt(StmtOp::BLOCK, first, (int)items.size());
+}
+
+/* ************************************************ */
+void FunctionBody::clear() {
+    func_id = -1;
+    num_params = 0;
+    var_types.clear();
+    exps.clear();
+    stmts.clear();
+    call_args.clear();
+    block_items.clear();
+    root = -1;
+    had_error = false;
+}
+
+/* ************************************************ */
+void FunctionBody::reserve(long num_tokens) {
+    // Every node comes from at least one token of the body.
+    exps.reserve(num_tokens);
+    stmts.reserve(num_tokens / 2);
+    block_items.reserve(num_tokens / 2);
+}
+
+/* ************************************************ */
+void body_declare(int symbol, TypeId type) {
+    if (symbol >= (int)var_of_symbol.size())
+        var_of_symbol.resize(symbol + 1);
+    var_of_symbol[symbol] = (int)current_body.var_types.size();
+    current_body.var_types.push_back(type);
+}
+
+/* ************************************************ */
+int body_var_of(int symbol) {
+    return var_of_symbol[symbol];
+}
+
+/* ************************************************ */
+void body_finished(Statements* statements) {
+    current_body.root = current_body.add_block(statements->items);
+    if (ranges_out)
+        analyze_ranges(current_body);
+    if (eval_calls)
+        pure_body_finished(current_body);
+}
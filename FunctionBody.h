@@ -0,0 +1,72 @@
+#ifndef COMPIHW3_FUNCTIONBODY_H
+#define COMPIHW3_FUNCTIONBODY_H
+
+#include "SemanticAnalyzer.h"
+
+/* A function body kept as a small tree, for analyses that have to walk a body more than once, such
+   as finding a fixpoint around a loop. The semantic actions build it while body_ir_enabled is set:
+   every Exp, Call and Statement gets the index of its node. Nodes refer to each other by index. */
+
+enum class ExpOp : unsigned char {
+    CONST, VAR, CALL, NOT, AND, OR,
+    ADD, SUB, MUL, DIV,
+    EQ, NE, LT, GT, LE, GE,
+    CAST,
+    OTHER   // Strings and expressions that had an error.
+};
+
+class ExpNode {
+public:
+    ExpOp op;
+    TypeId type;
+    int lineno;
+    int first = -1;  // CONST: value. VAR: variable. CALL: function id. NOT, CAST, binary: operand.
+    int second = -1; // Binary: right operand. CALL: index of the first argument in call_args.
+    int count = 0;   // CALL: number of arguments.
+};
+
+enum class StmtOp : unsigned char {
+    BLOCK, DECL, ASSIGN, CALL, RETURN, IF, WHILE, BREAK, CONTINUE
+};
+
+class StmtNode {
+public:
+    StmtOp op;
+    int lineno;
+    int first = -1;  // BLOCK: index of the first item in block_items. DECL, ASSIGN: variable.
+                     // CALL, RETURN, IF, WHILE: expression (-1 for a plain return).
+    int second = -1; // BLOCK: number of items. DECL, ASSIGN: expression (-1 for none). IF, WHILE: body.
+    int third = -1;  // IF: else part, -1 for none.
+};
+
+class FunctionBody {
+public:
+    int func_id = -1;
+    int num_params = 0;
+    vector<TypeId> var_types; // Parameters first, then locals in declaration order.
+    vector<ExpNode> exps;
+    vector<StmtNode> stmts;
+    vector<int> call_args;
+    vector<int> block_items;
+    int root = -1;            // The BLOCK of the whole body.
+    bool had_error = false;   // A semantic error was recorded (--all-errors) while building it.
+
+    int add_exp(ExpOp op, TypeId type, int first = -1, int second = -1);
+    int add_stmt(StmtOp op, int first = -1, int second = -1, int third = -1);
+    int add_block(const vector<int>& items);
+    // Empties the body, keeping the storage of its vectors for the next one.
+    void clear();
+    void reserve(long num_tokens);
+};
+
+extern bool body_ir_enabled;
+extern FunctionBody current_body;
+
+/* Variable of current_body declared as the given row of the symbol stack. */
+void body_declare(int symbol, TypeId type);
+int body_var_of(int symbol);
+
+/* Called when a body is complete, before its scope is closed. Runs the analyses that asked for it. */
+void body_finished(Statements* statements);
+
+#endif //COMPIHW3_FUNCTIONBODY_H
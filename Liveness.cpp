@@ -0,0 +1,89 @@
+#include "Liveness.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+using std::vector;
+
+LivenessTrace liveness;
+bool liveness_enabled;
+
+/* ************************************************ */
+void LivenessTrace::begin_function() {
+    now = 0;
+    locals.clear();
+    loops.clear();
+    open_loops.clear();
+}
+
+/* ************************************************ */
+void LivenessTrace::declare_local(int symbol) {
+    if (symbol >= (int)local_of_symbol.size())
+        local_of_symbol.resize(symbol + 1);
+    local_of_symbol[symbol] = (int)locals.size();
+    Local local;
+    local.declared = local.last_use = now++;
+    locals.push_back(local);
+}
+
+/* ************************************************ */
+void LivenessTrace::declare_param(int symbol) {
+    if (symbol >= (int)local_of_symbol.size())
+        local_of_symbol.resize(symbol + 1);
+    local_of_symbol[symbol] = -1;
+}
+
+/* ************************************************ */
+void LivenessTrace::reference(int symbol) {
+    int index = local_of_symbol[symbol];
+    if (index < 0)
+        return;
+    Local& local = locals[index];
+    local.last_use = now++;
+    // Open loops are nested, so their heads increase: find the first one started after the declaration.
+    auto first = std::upper_bound(open_loops.begin(), open_loops.end(), local.declared,
+                                  [this](int declared, int loop) { return declared < loops[loop].head; });
+    if (first != open_loops.end() && (local.outermost_loop < 0 || loops[*first].head < loops[local.outermost_loop].head))
+        local.outermost_loop = *first;
+}
+
+/* ************************************************ */
+void LivenessTrace::loop_head() {
+    open_loops.push_back((int)loops.size());
+    loops.push_back({ now++ });
+}
+
+/* ************************************************ */
+void LivenessTrace::loop_exit() {
+    loops[open_loops.back()].exit = now++;
+    open_loops.pop_back();
+}
+
+/* ************************************************ */
+int LivenessTrace::color() {
+    slot_of_local.assign(locals.size(), -1);
+    // Locals are declared in trace order, so they are already sorted by the start of their range.
+    std::priority_queue<int, vector<int>, std::greater<int>> free_slots;
+    std::priority_queue<std::pair<int, int>, vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> live; // (end, slot)
+    int num_slots = 0;
+    for (int i = 0; i < (int)locals.size(); i++) {
+        Local& local = locals[i];
+        if (local.outermost_loop >= 0)
+            local.last_use = std::max(local.last_use, loops[local.outermost_loop].exit);
+        while (!live.empty() && live.top().first < local.declared) {
+            free_slots.push(live.top().second);
+            live.pop();
+        }
+        int slot;
+        if (free_slots.empty()) {
+            slot = num_slots++;
+        } else {
+            slot = free_slots.top();
+            free_slots.pop();
+        }
+        slot_of_local[i] = slot;
+        live.push({ local.last_use, slot });
+    }
+    return num_slots;
+}
@@ -0,0 +1,50 @@
+#ifndef COMPIHW3_LIVENESS_H
+#define COMPIHW3_LIVENESS_H
+
+#include <vector>
+
+/* --liveness: the fewest slots the locals of a function need when two locals share a slot unless
+   both are live at once.
+
+   The body is seen as the linear trace of declarations and references the parser produces. A local
+   lives from its declaration to its last reference; one referenced inside a loop that started after
+   its declaration lives until that loop ends, because the next iteration may read it again. These
+   live ranges are intervals, so the interference graph is an interval graph and coloring the locals
+   greedily in declaration order uses the fewest slots. */
+class LivenessTrace {
+public:
+    void begin_function();
+    // symbol is the variable's index in the symbol stack.
+    void declare_local(int symbol);
+    void declare_param(int symbol);
+    void reference(int symbol);
+    // A while loop starts before its condition and ends after its body.
+    void loop_head();
+    void loop_exit();
+    // Colors the function's locals; returns the number of slots used.
+    int color();
+    std::vector<int> slot_of_local; // Filled by color(), in declaration order.
+
+private:
+    class Local {
+    public:
+        int declared;
+        int last_use;
+        int outermost_loop = -1; // Outermost loop started after the declaration that references it.
+    };
+    class Loop {
+    public:
+        int head;
+        int exit = -1;
+    };
+    int now = 0;
+    std::vector<Local> locals;
+    std::vector<Loop> loops;
+    std::vector<int> open_loops;
+    std::vector<int> local_of_symbol; // -1 for parameters.
+};
+
+extern LivenessTrace liveness;
+extern bool liveness_enabled;
+
+#endif //COMPIHW3_LIVENESS_H
@@ -0,0 +1,102 @@
+#include "OutputSink.h"
+#include "BatchIO.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <unistd.h>
+
+static OutputSink* installed_sink = nullptr;
+
+/* The streambuf behind std::cout: unbuffered itself, it hands every write to the sink. Formatted
+   output reaches it through xsputn, so there is one virtual call per string or number. */
+class SinkStreambuf : public std::streambuf {
+public:
+    explicit SinkStreambuf(OutputSink* sink) : sink(sink) {}
+
+protected:
+    int overflow(int c) override {
+        if (c != traits_type::eof()) {
+            char ch = (char)c;
+            sink->write(&ch, 1);
+        }
+        return traits_type::not_eof(c);
+    }
+    std::streamsize xsputn(const char* data, std::streamsize size) override {
+        sink->write(data, (size_t)size);
+        return size;
+    }
+    int sync() override {
+        sink->flush();
+        return 0;
+    }
+
+private:
+    OutputSink* sink;
+};
+
+/* ************************************************ */
+FdSink::FdSink(int fd, size_t capacity, bool line_mode, BatchIO* io) : fd(fd), buffer(capacity), line_mode(line_mode), io(io) {}
+
+/* ************************************************ */
+void FdSink::write(const char* data, size_t size) {
+    if (size > buffer.size() - used) {
+        flush();
+        // Too large to be worth copying.
+        if (size >= buffer.size()) {
+            write_fd(data, size);
+            return;
+        }
+    }
+    memcpy(buffer.data() + used, data, size);
+    used += size;
+    if (line_mode && memchr(data, '\n', size))
+        flush();
+}
+
+/* ************************************************ */
+void FdSink::flush() {
+    write_fd(buffer.data(), used);
+    used = 0;
+}
+
+/* ************************************************ */
+void FdSink::finish() {
+    flush();
+    if (io)
+        io->drain();
+}
+
+/* ************************************************ */
+void FdSink::write_fd(const char* data, size_t size) {
+    if (io) {
+        io->submit_write(fd, std::string(data, size), false);
+        return;
+    }
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        // Nothing to be done about a closed pipe or a full disk; the rest is dropped.
+        if (n <= 0)
+            return;
+        data += n;
+        size -= n;
+    }
+}
+
+/* ************************************************ */
+void install_output_sink(OutputSink* sink) {
+    installed_sink = sink;
+    // Never freed either: std::cout is flushed once more after static destructors have run.
+    std::cout.rdbuf(new SinkStreambuf(sink));
+    atexit(flush_output);
+}
+
+/* ************************************************ */
+void flush_output() {
+    if (installed_sink)
+        installed_sink->finish();
+}
@@ -0,0 +1,47 @@
+#ifndef COMPIHW3_OUTPUTSINK_H
+#define COMPIHW3_OUTPUTSINK_H
+
+#include <cstddef>
+#include <vector>
+
+class BatchIO;
+
+/* Destination of everything the analyzer prints. std::cout is pointed at the installed sink, so the
+   output code keeps writing to cout; it ends lines with '\n' rather than endl, and the sink decides
+   when the bytes reach the file. flush() writes out everything buffered so far, or starts to;
+   finish() waits until it is written. */
+class OutputSink {
+public:
+    virtual ~OutputSink() = default;
+    virtual void write(const char* data, size_t size) = 0;
+    virtual void flush() = 0;
+    virtual void finish() {}
+};
+
+/* Keeps writes to a file descriptor in a user-space buffer, written out with one write(2) when full.
+   In line mode, for interactive use, every write that ends a line is written out at once. Given a
+   BatchIO, full buffers are handed to it instead, and the analysis goes on while they are written. */
+class FdSink : public OutputSink {
+public:
+    FdSink(int fd, size_t capacity, bool line_mode, BatchIO* io = nullptr);
+    void write(const char* data, size_t size) override;
+    void flush() override;
+    void finish() override;
+
+private:
+    int fd;
+    std::vector<char> buffer;
+    size_t used = 0;
+    bool line_mode;
+    BatchIO* io;
+    void write_fd(const char* data, size_t size);
+};
+
+/* Points std::cout at sink and has exit() flush it. sink is never freed, so it outlives every
+   static destructor that might still print. */
+void install_output_sink(OutputSink* sink);
+
+/* Flushes the installed sink, if any, and waits for the write. Called before the analysis ends the process. */
+void flush_output();
+
+#endif //COMPIHW3_OUTPUTSINK_H
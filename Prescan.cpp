@@ -0,0 +1,142 @@
+#include "Prescan.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum CharClass : unsigned char {
+    OTHER, SPACE, WORD, QUOTE, SLASH, LBRACE, RBRACE, LPAREN, RPAREN, COMMA
+};
+
+/* ************************************************ */
+static std::array<unsigned char, 256> make_classes() {
+    std::array<unsigned char, 256> classes{};
+    for (int c = 0; c < 256; c++) {
+        if (isalnum(c))
+            classes[c] = WORD;
+    }
+    classes[' '] = classes['\t'] = classes['\n'] = classes['\r'] = SPACE;
+    classes['"'] = QUOTE;
+    classes['/'] = SLASH;
+    classes['{'] = LBRACE;
+    classes['}'] = RBRACE;
+    classes['('] = LPAREN;
+    classes[')'] = RPAREN;
+    classes[','] = COMMA;
+    return classes;
+}
+
+static const std::array<unsigned char, 256> char_class = make_classes();
+
+/* ************************************************ */
+InputProfile prescan(const char* data, size_t size) {
+    InputProfile profile;
+    const char* p = data;
+    const char* end = data + size;
+    int depth = 0;
+    long function_start = 0; // Token count when the current top-level item began.
+    bool in_header = false;  // Inside the parentheses of a top-level header.
+    bool header_has_params = false;
+    int header_commas = 0;
+    auto cls = [](char c) { return char_class[(unsigned char)c]; };
+    while (p < end) {
+        switch (cls(*p)) {
+            case SPACE:
+                p++;
+                break;
+            case WORD:
+                profile.tokens++;
+                header_has_params |= in_header;
+                while (++p < end && cls(*p) == WORD)
+                    ;
+                break;
+            case QUOTE:
+                // Ends at the closing quote, or at the end of the line if there is none (a lexical error).
+                profile.tokens++;
+                while (++p < end && *p != '"' && *p != '\n') {
+                    if (*p == '\\')
+                        p++;
+                }
+                p++;
+                break;
+            case SLASH:
+                if (p + 1 < end && p[1] == '/') {
+                    const char* newline = (const char*)memchr(p, '\n', end - p);
+                    p = newline ? newline + 1 : end;
+                } else {
+                    profile.tokens++;
+                    p++;
+                }
+                break;
+            case LBRACE:
+                profile.tokens++;
+                if (depth == 0)
+                    profile.functions++;
+                profile.max_depth = std::max(profile.max_depth, ++depth);
+                p++;
+                break;
+            case RBRACE:
+                profile.tokens++;
+                if (depth > 0 && --depth == 0) {
+                    profile.max_function_tokens = std::max(profile.max_function_tokens, profile.tokens - function_start);
+                    function_start = profile.tokens;
+                }
+                p++;
+                break;
+            case LPAREN:
+                profile.tokens++;
+                if (depth == 0) {
+                    in_header = true;
+                    header_has_params = false;
+                    header_commas = 0;
+                }
+                p++;
+                break;
+            case RPAREN:
+                profile.tokens++;
+                if (in_header && header_has_params)
+                    profile.max_params = std::max(profile.max_params, header_commas + 1);
+                in_header = false;
+                p++;
+                break;
+            case COMMA:
+                profile.tokens++;
+                header_commas += in_header;
+                p++;
+                break;
+            default:
+                profile.tokens++;
+                p++;
+                break;
+        }
+    }
+    profile.max_function_tokens = std::max(profile.max_function_tokens, profile.tokens - function_start);
+    return profile;
+}
+
+/* ************************************************ */
+std::string read_all(int fd) {
+    std::string data;
+    struct stat info;
+    // A regular file fits in the first buffer; the extra byte lets the second read see its end.
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode))
+        data.resize((size_t)info.st_size + 1);
+    else
+        data.resize(1 << 16);
+    size_t used = 0;
+    while (true) {
+        if (used == data.size())
+            data.resize(2 * used);
+        ssize_t n = read(fd, &data[used], data.size() - used);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        used += n;
+    }
+    data.resize(used);
+    return data;
+}
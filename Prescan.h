@@ -0,0 +1,24 @@
+#ifndef COMPIHW3_PRESCAN_H
+#define COMPIHW3_PRESCAN_H
+
+#include <cstddef>
+#include <string>
+
+/* Sizes of an input, found by one pass over its bytes before it is lexed, so that the tables the
+   analysis grows can be reserved up front. They only steer allocation: on input that does not lex
+   or has unbalanced braces they are rough, and nothing else depends on them. */
+class InputProfile {
+public:
+    long tokens = 0;              // At least the number of tokens; a two-character operator counts twice.
+    int functions = 0;            // Blocks at the top level.
+    int max_depth = 0;            // Of nested braces.
+    int max_params = 0;           // Of a top-level header.
+    long max_function_tokens = 0; // Tokens of the largest function, header included.
+};
+
+InputProfile prescan(const char* data, size_t size);
+
+/* All of a file descriptor's remaining bytes. */
+std::string read_all(int fd);
+
+#endif //COMPIHW3_PRESCAN_H
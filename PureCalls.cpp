@@ -0,0 +1,197 @@
+#include "PureCalls.h"
+
+bool eval_calls;
+
+// Expressions and statements one folded call may run, nested calls included.
+constexpr int step_budget = 100000;
+constexpr int depth_limit = 64;
+
+static vector<FunctionBody> pure_bodies; // By function id; root is -1 for functions that are not kept.
+
+/* ************************************************ */
+static bool is_value_type(TypeId type) {
+    return type == TypeId::INT || type == TypeId::BYTE || type == TypeId::BOOL;
+}
+
+/* ************************************************ */
+static bool is_kept(int func_id) {
+    return func_id < (int)pure_bodies.size() && pure_bodies[func_id].root >= 0;
+}
+
+/* ************************************************ */
+void clear_pure_bodies() {
+    pure_bodies.clear();
+}
+
+/* ************************************************ */
+void pure_body_finished(const FunctionBody& body) {
+    const FuncSignature& func = functions_table[body.func_id];
+    if (body.had_error || !is_value_type(func.ret_type))
+        return;
+    for (TypeId type : func.param_types) {
+        if (!is_value_type(type))
+            return;
+    }
+    for (const auto& exp : body.exps) {
+        // OTHER is a string, which only print takes, or an expression that had an error.
+        if (exp.op == ExpOp::OTHER)
+            return;
+        if (exp.op == ExpOp::CALL && exp.first != body.func_id && !is_kept(exp.first))
+            return;
+    }
+    if (body.func_id >= (int)pure_bodies.size())
+        pure_bodies.resize(body.func_id + 1);
+    pure_bodies[body.func_id] = body;
+}
+
+enum class Flow { NEXT, BREAK, CONTINUE, RETURN };
+
+class Evaluator {
+public:
+    bool failed = false;
+
+    int call(int func_id, const vector<int>& args) {
+        if (depth == depth_limit) {
+            failed = true;
+            return 0;
+        }
+        depth++;
+        Frame frame(pure_bodies[func_id]);
+        std::copy(args.begin(), args.end(), frame.vars.begin());
+        // Running off the end of a function that returns a value leaves no value to fold.
+        if (exec(frame, frame.body.root) != Flow::RETURN)
+            failed = true;
+        depth--;
+        return frame.result;
+    }
+
+private:
+    class Frame {
+    public:
+        explicit Frame(const FunctionBody& body) : body(body), vars(body.var_types.size(), 0) {}
+        const FunctionBody& body;
+        vector<int> vars; // Locals start at 0, as in generated code.
+        int result = 0;
+    };
+
+    int steps = step_budget;
+    int depth = 0;
+
+    /* Stops the evaluation when the budget is spent. */
+    bool step() {
+        if (--steps < 0)
+            failed = true;
+        return !failed;
+    }
+
+    int eval(Frame& frame, int e) {
+        if (!step())
+            return 0;
+        const ExpNode& node = frame.body.exps[e];
+        switch (node.op) {
+            case ExpOp::CONST:
+                return node.first;
+            case ExpOp::VAR:
+                return frame.vars[node.first];
+            case ExpOp::CALL: {
+                vector<int> args;
+                for (int i = 0; i < node.count; i++)
+                    args.push_back(eval(frame, frame.body.call_args[node.second + i]));
+                return failed ? 0 : call(node.first, args);
+            }
+            case ExpOp::NOT:
+                return !eval(frame, node.first);
+            case ExpOp::AND:
+                return eval(frame, node.first) && eval(frame, node.second);
+            case ExpOp::OR:
+                return eval(frame, node.first) || eval(frame, node.second);
+            case ExpOp::CAST: {
+                int value = eval(frame, node.first);
+                return node.type == TypeId::BYTE ? value & 0xff : value;
+            }
+            default:
+                break;
+        }
+        long long first = eval(frame, node.first);
+        long long second = eval(frame, node.second);
+        long long result;
+        switch (node.op) {
+            case ExpOp::ADD: result = first + second; break;
+            case ExpOp::SUB: result = first - second; break;
+            case ExpOp::MUL: result = first * second; break;
+            case ExpOp::DIV:
+                if (second == 0) {
+                    failed = true;
+                    return 0;
+                }
+                result = first / second;
+                break;
+            case ExpOp::EQ: return first == second;
+            case ExpOp::NE: return first != second;
+            case ExpOp::LT: return first < second;
+            case ExpOp::GT: return first > second;
+            case ExpOp::LE: return first <= second;
+            default: return first >= second;
+        }
+        if (node.type == TypeId::BYTE)
+            result &= 0xff;
+        return (int)(unsigned int)result;
+    }
+
+    Flow exec(Frame& frame, int s) {
+        if (!step())
+            return Flow::RETURN;
+        const StmtNode& node = frame.body.stmts[s];
+        switch (node.op) {
+            case StmtOp::BLOCK:
+                for (int i = 0; i < node.second; i++) {
+                    Flow flow = exec(frame, frame.body.block_items[node.first + i]);
+                    if (flow != Flow::NEXT)
+                        return flow;
+                }
+                return Flow::NEXT;
+            case StmtOp::DECL:
+            case StmtOp::ASSIGN:
+                frame.vars[node.first] = node.second < 0 ? 0 : eval(frame, node.second);
+                return Flow::NEXT;
+            case StmtOp::CALL:
+                eval(frame, node.first);
+                return Flow::NEXT;
+            case StmtOp::RETURN:
+                if (node.first < 0)
+                    failed = true;
+                else
+                    frame.result = eval(frame, node.first);
+                return Flow::RETURN;
+            case StmtOp::IF:
+                if (eval(frame, node.first))
+                    return exec(frame, node.second);
+                return node.third < 0 ? Flow::NEXT : exec(frame, node.third);
+            case StmtOp::WHILE:
+                while (!failed && eval(frame, node.first)) {
+                    Flow flow = exec(frame, node.second);
+                    if (flow == Flow::BREAK)
+                        break;
+                    if (flow == Flow::RETURN)
+                        return flow;
+                }
+                return Flow::NEXT;
+            case StmtOp::BREAK:
+                return Flow::BREAK;
+            default:
+                return Flow::CONTINUE;
+        }
+    }
+};
+
+/* ************************************************ */
+bool evaluate_call(int func_id, const vector<int>& args, int& result) {
+    if (!is_kept(func_id))
+        return false;
+    Evaluator evaluator;
+    result = evaluator.call(func_id, args);
+    if (evaluator.failed)
+        return false;
+    stats.folded_calls++;
+    return true;
+}
@@ -0,0 +1,25 @@
+#ifndef COMPIHW3_PURECALLS_H
+#define COMPIHW3_PURECALLS_H
+
+#include "FunctionBody.h"
+
+/* --eval-calls: calls of pure functions with constant arguments are folded like constant
+   expressions, by running the callee's body at analysis time.
+
+   A function is pure when its parameters and return value are ints, bytes or bools, and it calls
+   only itself and other pure functions (so never print or printi). Its body is kept once complete.
+   A call is folded when every argument is folded and the callee returns within a budget of steps
+   and nested calls; otherwise, including on division by zero, the call is left alone.
+   The folded results are checked, like other constants, only under --const-checks. */
+extern bool eval_calls;
+
+/* Keeps body for evaluation if its function is pure and had no errors. */
+void pure_body_finished(const FunctionBody& body);
+
+/* Forgets the kept bodies, before the next input. */
+void clear_pure_bodies();
+
+/* Value of func_id applied to args, if it is a kept body that returns within the budget. */
+bool evaluate_call(int func_id, const vector<int>& args, int& result);
+
+#endif //COMPIHW3_PURECALLS_H
@@ -0,0 +1,486 @@
+#include "RangeAnalysis.h"
+#include <algorithm>
+#include <climits>
+
+std::ostream* ranges_out;
+
+// Rounds around a loop before bounds that still move are widened.
+constexpr int widen_after = 3;
+// Rounds after widening that tighten the bounds again.
+constexpr int narrow_rounds = 2;
+
+class Range {
+public:
+    long long lo;
+    long long hi;
+    bool empty() const { return lo > hi; }
+    bool contains(long long value) const { return lo <= value && value <= hi; }
+    bool within(const Range& other) const { return other.lo <= lo && hi <= other.hi; }
+    bool operator==(const Range& other) const { return lo == other.lo && hi == other.hi; }
+};
+
+static const Range no_values = { 1, 0 };
+
+/* ************************************************ */
+static Range hull(const Range& a, const Range& b) {
+    if (a.empty())
+        return b;
+    if (b.empty())
+        return a;
+    return { std::min(a.lo, b.lo), std::max(a.hi, b.hi) };
+}
+
+/* ************************************************ */
+static Range type_range(TypeId type) {
+    switch (type) {
+        case TypeId::BYTE: return { 0, 255 };
+        case TypeId::BOOL: return { 0, 1 };
+        default: return { INT_MIN, INT_MAX };
+    }
+}
+
+/* Variable intervals at one point of the body; unreachable points hold none. */
+class State {
+public:
+    bool reachable = false;
+    vector<Range> vars;
+    bool operator==(const State& other) const { return reachable == other.reachable && vars == other.vars; }
+};
+
+/* ************************************************ */
+static State join(const State& a, const State& b) {
+    if (!a.reachable)
+        return b;
+    if (!b.reachable)
+        return a;
+    State result = a;
+    for (size_t v = 0; v < result.vars.size(); v++)
+        result.vars[v] = hull(a.vars[v], b.vars[v]);
+    return result;
+}
+
+/* ************************************************ */
+static ExpOp negated(ExpOp op) {
+    switch (op) {
+        case ExpOp::EQ: return ExpOp::NE;
+        case ExpOp::NE: return ExpOp::EQ;
+        case ExpOp::LT: return ExpOp::GE;
+        case ExpOp::GE: return ExpOp::LT;
+        case ExpOp::GT: return ExpOp::LE;
+        default: return ExpOp::GT;
+    }
+}
+
+/* a op b turned around to b op' a. */
+static ExpOp mirror(ExpOp op) {
+    switch (op) {
+        case ExpOp::LT: return ExpOp::GT;
+        case ExpOp::GT: return ExpOp::LT;
+        case ExpOp::LE: return ExpOp::GE;
+        case ExpOp::GE: return ExpOp::LE;
+        default: return op;
+    }
+}
+
+/* ************************************************ */
+static bool is_relop(ExpOp op) {
+    return op >= ExpOp::EQ && op <= ExpOp::GE;
+}
+
+/* ************************************************ */
+static const char* op_text(ExpOp op) {
+    switch (op) {
+        case ExpOp::ADD: return "+";
+        case ExpOp::SUB: return "-";
+        case ExpOp::MUL: return "*";
+        case ExpOp::DIV: return "/";
+        default: return "cast";
+    }
+}
+
+/* ************************************************ */
+static Range divide(const Range& a, const Range& b) {
+    // Quotients are monotone in each operand while the divisor keeps its sign, so the corners bound them.
+    auto corners = [&](long long lo, long long hi) {
+        long long q[] = { a.lo / lo, a.lo / hi, a.hi / lo, a.hi / hi };
+        return Range{ *std::min_element(q, q + 4), *std::max_element(q, q + 4) };
+    };
+    // Dividing by zero stops the program, so zero itself contributes nothing.
+    Range result = no_values;
+    if (b.lo < 0)
+        result = hull(result, corners(b.lo, std::min(b.hi, -1LL)));
+    if (b.hi > 0)
+        result = hull(result, corners(std::max(b.lo, 1LL), b.hi));
+    return result;
+}
+
+class RangeAnalyzer {
+public:
+    explicit RangeAnalyzer(const FunctionBody& body)
+        : body(body), seen(body.exps.size(), no_values), unwrapped(body.exps.size(), no_values), solutions(body.stmts.size()) {}
+
+    void run() {
+        State entry;
+        entry.reachable = true;
+        for (TypeId type : body.var_types)
+            entry.vars.push_back(type_range(type));
+        exec(body.root, entry);
+    }
+
+    void write(std::ostream& out) const {
+        const string& function = functions_table[body.func_id].name;
+        for (int e = 0; e < (int)body.exps.size(); e++) {
+            const ExpNode& node = body.exps[e];
+            bool arithmetic = node.op >= ExpOp::ADD && node.op <= ExpOp::DIV;
+            bool byte_cast = node.op == ExpOp::CAST && node.type == TypeId::BYTE;
+            if ((!arithmetic && !byte_cast) || seen[e].empty())
+                continue;
+            out << "{\"function\":\"" << function << "\",\"line\":" << node.lineno << ",\"exp\":" << e
+                << ",\"op\":\"" << op_text(node.op) << "\",\"type\":\"" << type_name(node.type) << "\""
+                << ",\"min\":" << seen[e].lo << ",\"max\":" << seen[e].hi
+                << ",\"no_wrap\":" << (unwrapped[e].within(type_range(node.type)) ? "true" : "false");
+            if (node.op == ExpOp::DIV)
+                out << ",\"nonzero_divisor\":" << (seen[node.second].contains(0) ? "false" : "true");
+            out << "}\n";
+        }
+    }
+
+private:
+    class Loop {
+    public:
+        State breaks;
+        State continues;
+    };
+
+    /* Where a loop settled the last time it was solved. */
+    class Solution {
+    public:
+        State entry;           // The state it was solved from.
+        State head;            // Its stable head, after narrowing.
+        State exit;
+        vector<bool> assigned; // Variables declared or assigned in its body; empty until first solved.
+    };
+
+    const FunctionBody& body;
+    vector<Range> seen;      // Join of every value each expression produced.
+    vector<Range> unwrapped; // Arithmetic and casts: the same before wrapping to the type.
+    vector<Loop> loops;
+    vector<Solution> solutions; // By statement, for loops.
+    bool recording = true;   // Off while evaluating for a condition, which is recorded separately.
+
+    Range eval(int e, const State& state) {
+        const ExpNode& node = body.exps[e];
+        Range result = type_range(node.type);
+        Range raw = no_values;
+        switch (node.op) {
+            case ExpOp::CONST:
+                result = { node.first, node.first };
+                break;
+            case ExpOp::VAR:
+                result = state.vars[node.first];
+                break;
+            case ExpOp::CALL:
+                for (int i = 0; i < node.count; i++)
+                    eval(body.call_args[node.second + i], state);
+                break;
+            case ExpOp::NOT: {
+                Range operand = eval(node.first, state);
+                result = { 1 - operand.hi, 1 - operand.lo };
+                break;
+            }
+            case ExpOp::AND:
+            case ExpOp::OR: {
+                Range left = eval(node.first, state);
+                // The right operand runs only when the left one did not decide.
+                State rest = state;
+                refine(node.first, node.op == ExpOp::AND, rest);
+                Range right = rest.reachable ? eval(node.second, rest) : Range{ 0, 0 };
+                if (node.op == ExpOp::AND)
+                    result = { left.lo & right.lo, left.hi & right.hi };
+                else
+                    result = { left.lo | right.lo, left.hi | right.hi };
+                break;
+            }
+            case ExpOp::ADD:
+            case ExpOp::SUB:
+            case ExpOp::MUL:
+            case ExpOp::DIV: {
+                Range a = eval(node.first, state);
+                Range b = eval(node.second, state);
+                if (node.op == ExpOp::ADD) {
+                    raw = { a.lo + b.lo, a.hi + b.hi };
+                } else if (node.op == ExpOp::SUB) {
+                    raw = { a.lo - b.hi, a.hi - b.lo };
+                } else if (node.op == ExpOp::MUL) {
+                    long long p[] = { a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi };
+                    raw = { *std::min_element(p, p + 4), *std::max_element(p, p + 4) };
+                } else {
+                    raw = divide(a, b);
+                }
+                if (!raw.empty() && raw.within(type_range(node.type)))
+                    result = raw;
+                break;
+            }
+            case ExpOp::CAST: {
+                raw = eval(node.first, state);
+                if (raw.within(type_range(node.type)))
+                    result = raw;
+                break;
+            }
+            default:
+                if (is_relop(node.op)) {
+                    Range a = eval(node.first, state);
+                    Range b = eval(node.second, state);
+                    result = compare(node.op, a, b);
+                }
+                break;
+        }
+        if (recording) {
+            seen[e] = hull(seen[e], result);
+            unwrapped[e] = hull(unwrapped[e], raw);
+        }
+        return result;
+    }
+
+    /* Possible truth values of a op b. */
+    static Range compare(ExpOp op, const Range& a, const Range& b) {
+        bool always, never;
+        switch (op) {
+            case ExpOp::EQ: always = a.lo == a.hi && a == b; never = a.hi < b.lo || b.hi < a.lo; break;
+            case ExpOp::NE: always = a.hi < b.lo || b.hi < a.lo; never = a.lo == a.hi && a == b; break;
+            case ExpOp::LT: always = a.hi < b.lo; never = a.lo >= b.hi; break;
+            case ExpOp::LE: always = a.hi <= b.lo; never = a.lo > b.hi; break;
+            case ExpOp::GT: always = a.lo > b.hi; never = a.hi <= b.lo; break;
+            default: always = a.lo >= b.hi; never = a.hi < b.lo; break;
+        }
+        return { always ? 1 : 0, never ? 0 : 1 };
+    }
+
+    /* Narrows var to the values for which var op bound can hold. */
+    static void constrain(Range& var, ExpOp op, const Range& bound) {
+        switch (op) {
+            case ExpOp::LT: var.hi = std::min(var.hi, bound.hi - 1); break;
+            case ExpOp::LE: var.hi = std::min(var.hi, bound.hi); break;
+            case ExpOp::GT: var.lo = std::max(var.lo, bound.lo + 1); break;
+            case ExpOp::GE: var.lo = std::max(var.lo, bound.lo); break;
+            case ExpOp::EQ: var = { std::max(var.lo, bound.lo), std::min(var.hi, bound.hi) }; break;
+            default:
+                if (bound.lo == bound.hi && var.lo == bound.lo)
+                    var.lo++;
+                else if (bound.lo == bound.hi && var.hi == bound.lo)
+                    var.hi--;
+                break;
+        }
+    }
+
+    /* Narrows state to the executions in which condition e evaluates to truth. */
+    void refine(int e, bool truth, State& state) {
+        if (!state.reachable)
+            return;
+        const ExpNode& node = body.exps[e];
+        bool saved = recording;
+        recording = false;
+        switch (node.op) {
+            case ExpOp::NOT:
+                refine(node.first, !truth, state);
+                break;
+            case ExpOp::AND:
+            case ExpOp::OR:
+                if (truth == (node.op == ExpOp::AND)) {
+                    // Both operands had this value.
+                    refine(node.first, truth, state);
+                    refine(node.second, truth, state);
+                } else {
+                    // Decided by the left operand, or by the right one after the left did not decide.
+                    State by_left = state;
+                    refine(node.first, truth, by_left);
+                    refine(node.first, !truth, state);
+                    refine(node.second, truth, state);
+                    state = join(by_left, state);
+                }
+                break;
+            case ExpOp::CONST:
+                if ((node.first != 0) != truth)
+                    state.reachable = false;
+                break;
+            case ExpOp::VAR:
+                constrain(state.vars[node.first], ExpOp::EQ, { truth, truth });
+                break;
+            default:
+                if (is_relop(node.op)) {
+                    ExpOp op = truth ? node.op : negated(node.op);
+                    const ExpNode& left = body.exps[node.first];
+                    const ExpNode& right = body.exps[node.second];
+                    if (left.op == ExpOp::VAR)
+                        constrain(state.vars[left.first], op, eval(node.second, state));
+                    if (right.op == ExpOp::VAR)
+                        constrain(state.vars[right.first], mirror(op), eval(node.first, state));
+                }
+                break;
+        }
+        recording = saved;
+        for (const auto& var : state.vars) {
+            if (var.empty())
+                state.reachable = false;
+        }
+    }
+
+    /* Value a variable of the given type holds after being assigned value. */
+    static Range assigned(TypeId type, const Range& value) {
+        return value.within(type_range(type)) ? value : type_range(type);
+    }
+
+    void exec(int s, State& state) {
+        // Statements that had an error have no node.
+        if (s < 0 || !state.reachable)
+            return;
+        const StmtNode& node = body.stmts[s];
+        switch (node.op) {
+            case StmtOp::BLOCK:
+                for (int i = 0; i < node.second; i++)
+                    exec(body.block_items[node.first + i], state);
+                break;
+            case StmtOp::DECL:
+            case StmtOp::ASSIGN: {
+                TypeId type = body.var_types[node.first];
+                state.vars[node.first] = node.second < 0 ? type_range(type) : assigned(type, eval(node.second, state));
+                break;
+            }
+            case StmtOp::CALL:
+                eval(node.first, state);
+                break;
+            case StmtOp::RETURN:
+                if (node.first >= 0)
+                    eval(node.first, state);
+                state.reachable = false;
+                break;
+            case StmtOp::IF: {
+                eval(node.first, state);
+                State then_state = state;
+                refine(node.first, true, then_state);
+                exec(node.second, then_state);
+                refine(node.first, false, state);
+                if (node.third >= 0)
+                    exec(node.third, state);
+                state = join(then_state, state);
+                break;
+            }
+            case StmtOp::WHILE:
+                exec_loop(s, state);
+                break;
+            case StmtOp::BREAK:
+            case StmtOp::CONTINUE:
+                // Outside of a loop only with --all-errors, which reported it.
+                if (!loops.empty() && node.op == StmtOp::BREAK)
+                    loops.back().breaks = join(loops.back().breaks, state);
+                else if (!loops.empty())
+                    loops.back().continues = join(loops.back().continues, state);
+                state.reachable = false;
+                break;
+        }
+    }
+
+    /* One pass over a loop from the state at its head: the states that reach the head again. */
+    State loop_round(const StmtNode& node, const State& head) {
+        loops.back() = Loop();
+        eval(node.first, head);
+        State body_state = head;
+        refine(node.first, true, body_state);
+        exec(node.second, body_state);
+        return join(body_state, loops.back().continues);
+    }
+
+    void mark_assigned(int s, vector<bool>& assigned) const {
+        if (s < 0)
+            return;
+        const StmtNode& node = body.stmts[s];
+        switch (node.op) {
+            case StmtOp::BLOCK:
+                for (int i = 0; i < node.second; i++)
+                    mark_assigned(body.block_items[node.first + i], assigned);
+                break;
+            case StmtOp::DECL:
+            case StmtOp::ASSIGN:
+                assigned[node.first] = true;
+                break;
+            case StmtOp::IF:
+                mark_assigned(node.second, assigned);
+                mark_assigned(node.third, assigned);
+                break;
+            case StmtOp::WHILE:
+                mark_assigned(node.second, assigned);
+                break;
+            default:
+                break;
+        }
+    }
+
+    /* A stable head for the loop from entry. Each round of an outer loop solves its inner loops again,
+       so solving from scratch would cost a factor per level of nesting. Instead the variables the loop
+       assigns start where they settled last time, which is usually stable already; the others are
+       taken from entry as they are, since the loop only narrows them. */
+    State solve(const StmtNode& node, const State& entry, Solution& solution) {
+        State head = entry;
+        if (solution.head.reachable) {
+            for (size_t v = 0; v < head.vars.size(); v++) {
+                if (solution.assigned[v])
+                    head.vars[v] = hull(head.vars[v], solution.head.vars[v]);
+            }
+        } else if (solution.assigned.empty()) {
+            solution.assigned.assign(body.var_types.size(), false);
+            mark_assigned(node.second, solution.assigned);
+        }
+        for (int round = 0; ; round++) {
+            State next = join(head, loop_round(node, head));
+            if (next == head)
+                break;
+            if (round >= widen_after) {
+                for (size_t v = 0; v < next.vars.size(); v++) {
+                    if (head.vars[v].empty())
+                        continue;
+                    Range limits = type_range(body.var_types[v]);
+                    if (next.vars[v].lo < head.vars[v].lo)
+                        next.vars[v].lo = limits.lo;
+                    if (next.vars[v].hi > head.vars[v].hi)
+                        next.vars[v].hi = limits.hi;
+                }
+            }
+            head = next;
+        }
+        // Widening overshoots; passes from the stable head win back bounds that the condition enforces.
+        for (int round = 0; round < narrow_rounds; round++)
+            head = join(entry, loop_round(node, head));
+        return head;
+    }
+
+    void exec_loop(int s, State& state) {
+        const StmtNode& node = body.stmts[s];
+        Solution& solution = solutions[s];
+        // Rounds of an outer loop that reach this one in the same state, and the recording pass after
+        // them, reuse its solution.
+        bool solved = solution.entry == state;
+        if (solved && !recording) {
+            state = solution.exit;
+            return;
+        }
+        loops.emplace_back();
+        bool saved = recording;
+        recording = false;
+        State head = solved ? solution.head : solve(node, state, solution);
+        recording = saved;
+        loop_round(node, head);
+        solution.entry = state;
+        solution.head = head;
+        refine(node.first, false, head);
+        state = join(head, loops.back().breaks);
+        solution.exit = state;
+        loops.pop_back();
+    }
+};
+
+/* ************************************************ */
+void analyze_ranges(const FunctionBody& body) {
+    RangeAnalyzer analyzer(body);
+    analyzer.run();
+    analyzer.write(*ranges_out);
+}
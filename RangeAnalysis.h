@@ -0,0 +1,22 @@
+#ifndef COMPIHW3_RANGEANALYSIS_H
+#define COMPIHW3_RANGEANALYSIS_H
+
+#include "FunctionBody.h"
+#include <ostream>
+
+/* --ranges=FILE: interval analysis of int and byte values.
+
+   Every variable holds an interval, updated by declarations and assignments, narrowed by the
+   conditions of if and while, and joined where control flow meets. A loop is iterated until its
+   entry state stops changing; after a few rounds, bounds that keep moving are widened to the limits
+   of the type, so this always ends. An inner loop starts from where it settled in the previous round
+   of the outer loop, so nesting costs no more than a few passes per level.
+
+   One JSON object per line is written for each arithmetic operation and each cast to byte that can
+   execute: the interval of its value and whether it provably never wraps, plus, for a division,
+   whether the divisor is provably never zero. Lines come in source order within a function. */
+extern std::ostream* ranges_out;
+
+void analyze_ranges(const FunctionBody& body);
+
+#endif //COMPIHW3_RANGEANALYSIS_H
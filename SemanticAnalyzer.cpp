@@ -1,15 +1,118 @@
 #include "SemanticAnalyzer.h"
+#include "CallGraph.h"
+#include "FrameLayout.h"
+#include "FunctionBody.h"
+#include "Liveness.h"
+#include "OutputSink.h"
+#include "Prescan.h"
+#include "PureCalls.h"
+#include "SymbolDb.h"
 #include <cstring>
+#include <climits>
+#include <cmath>
+#include <sstream>
+#include <algorithm>
+#include <unordered_set>
 
 using namespace output;
 
-vector<SymbolTable> tables_stack;
-vector<int> offset_stack;
-string current_function_name;
+// Variables of all open scopes, innermost last. The global scope holds only functions (functions_table).
+vector<SymbolEntry> symbol_stack;
+vector<Scope> scopes;
+vector<FuncSignature> functions_table;
+vector<int> function_of_name; // Indexed by name id, -1 if no function has that name.
+vector<string> names;
+std::unordered_map<string, int> name_ids;
+int current_function;
+int visible_functions;
+bool checking_slices;
+bool throw_on_error;
+bool collect_errors;
+bool constant_checks;
+AnalyzerStats stats;
 int num_of_loops;
 int cur_if_line;
 int cur_while_line;
 
+/* ************************************************ */
+void abort_analysis() {
+    if (throw_on_error)
+        throw AnalysisAborted();
+    flush_output();
+    exit(0);
+}
+
+/* A recorded error, printed by print_diagnostics(). */
+class Diagnostic {
+public:
+    int lineno;
+    string message;
+};
+
+int errors_recorded;
+static vector<Diagnostic> diagnostics;
+static std::ostringstream pending_error; // Error stream while collecting: holds the message being reported.
+static int error_limit;
+
+/* ************************************************ */
+void collect_diagnostics(int max_errors) {
+    collect_errors = true;
+    error_limit = max_errors;
+    setErrorStream(pending_error);
+}
+
+/* ************************************************ */
+static void record_error(int lineno) {
+    diagnostics.push_back({ lineno, pending_error.str() });
+    pending_error.str("");
+}
+
+/* ************************************************ */
+void semantic_error(int lineno) {
+    if (!collect_errors)
+        abort_analysis();
+    record_error(lineno);
+    errors_recorded++;
+    current_body.had_error = true;
+}
+
+/* ************************************************ */
+void semantic_warning(int lineno) {
+    if (collect_errors)
+        record_error(lineno);
+}
+
+/* ************************************************ */
+void fatal_error(int lineno) {
+    if (collect_errors) {
+        record_error(lineno);
+        print_diagnostics();
+    }
+    abort_analysis();
+}
+
+/* ************************************************ */
+void print_diagnostics() {
+    // Errors are found in source order except the ones reported at a function header or at the end.
+    std::stable_sort(diagnostics.begin(), diagnostics.end(),
+                     [](const Diagnostic& a, const Diagnostic& b) { return a.lineno < b.lineno; });
+    int shown = std::min((int)diagnostics.size(), error_limit);
+    for (int i = 0; i < shown; i++)
+        std::cout << diagnostics[i].message;
+    if (shown < (int)diagnostics.size())
+        errorsNotShown((int)diagnostics.size() - shown);
+    diagnostics.clear();
+}
+
+/* ************************************************ */
+/* FanC ints are 32 bit and wrap around. */
+static int wrap_int(long long value) {
+    return (int)(unsigned int)value;
+}
+
+static void open_shared_loop();
+static void close_shared_loop();
+
 /* ************************************************ */
 void loop_entered() {
     cur_while_line = yylineno;
@@ -19,6 +122,26 @@ void loop_entered() {
 /* ************************************************ */
 void loop_exited() {
     num_of_loops--;
+    close_shared_loop();
+    if (liveness_enabled)
+        liveness.loop_exit();
+}
+
+/* ************************************************ */
+void loop_head_reached() {
+    open_shared_loop();
+    if (liveness_enabled)
+        liveness.loop_head();
+}
+
+/* Times a statement or call at the current loop depth is assumed to run per call of its function. */
+static double loop_weight() {
+    return std::pow(loop_trips, num_of_loops);
+}
+
+/* ************************************************ */
+static void count_statement() {
+    call_graph.add_statement(current_function, loop_weight());
 }
 
 /* ************************************************ */
@@ -26,75 +149,402 @@ void enter_if() {
     cur_if_line = yylineno;
 }
 
+/* ************************************************ */
+FuncSignature::FuncSignature(const string& name, TypeId ret_type, const vector<TypeId>& param_types, const vector<bool>& const_params) :
+    name(name), ret_type(ret_type), arity((int)param_types.size()), param_types(param_types), const_params(const_params) {
+    args_string = intern_args_string(param_types);
+    type_string = intern_type_string(ret_type, param_types);
+}
+
+static std::unordered_set<string> signature_strings; // Nodes never move, so the strings are stable.
+static string signature_scratch; // Formatted into before the lookup; a known signature allocates nothing.
+
+/* ************************************************ */
+static void append_type_list(string& out, const vector<TypeId>& types) {
+    out += '(';
+    for (size_t i = 0; i < types.size(); i++) {
+        if (i > 0)
+            out += ',';
+        out.append(type_name(types[i]), type_name_lengths[idx(types[i])]);
+    }
+    out += ')';
+}
+
+/* ************************************************ */
+static const string* intern_signature_scratch() {
+    auto it = signature_strings.find(signature_scratch);
+    if (it == signature_strings.end())
+        it = signature_strings.insert(signature_scratch).first;
+    return &*it;
+}
+
+/* ************************************************ */
+const string* intern_args_string(const vector<TypeId>& param_types) {
+    signature_scratch.clear();
+    append_type_list(signature_scratch, param_types);
+    return intern_signature_scratch();
+}
+
+/* ************************************************ */
+const string* intern_type_string(TypeId ret_type, const vector<TypeId>& param_types) {
+    signature_scratch.clear();
+    append_type_list(signature_scratch, param_types);
+    signature_scratch += "->";
+    signature_scratch.append(type_name(ret_type), type_name_lengths[idx(ret_type)]);
+    return intern_signature_scratch();
+}
+
+/* ************************************************ */
+int intern_name(const string& name) {
+    // Look up first: emplace would allocate a node even for a known name.
+    auto it = name_ids.find(name);
+    if (it != name_ids.end())
+        return it->second;
+    int name_id = (int)names.size();
+    name_ids.emplace(name, name_id);
+    names.push_back(name);
+    function_of_name.push_back(-1);
+    return name_id;
+}
+
+/* ************************************************ */
+int find_name(const string& name) {
+    auto it = name_ids.find(name);
+    return it == name_ids.end() ? -1 : it->second;
+}
+
+/* ************************************************ */
+const string& name_of(int name_id) {
+    return names[name_id];
+}
+
+/* ************************************************ */
+int find_function(const string& name) {
+    int name_id = find_name(name);
+    if (name_id < 0)
+        return -1;
+    int func_id = function_of_name[name_id];
+    return func_id < visible_functions ? func_id : -1;
+}
+
+/* ************************************************ */
+int register_function(const string& name, TypeId ret_type, const vector<TypeId>& param_types, const vector<bool>& const_params) {
+    int id = (int)functions_table.size();
+    functions_table.emplace_back(name, ret_type, param_types, const_params);
+    int name_id = intern_name(name);
+    // A redefinition is an error found when its body is checked; lookups keep the first one.
+    if (function_of_name[name_id] < 0)
+        function_of_name[name_id] = id;
+    return id;
+}
+
+/* ************************************************ */
+static int declare_function(const string& name, TypeId ret_type, const vector<TypeId>& param_types, const vector<bool>& const_params) {
+    if (!checking_slices)
+        register_function(name, ret_type, param_types, const_params);
+    call_graph.add_function(visible_functions, (int)param_types.size());
+    return visible_functions++;
+}
+
+/* Hash-consing table of Exp::share, in which every open scope can see the expressions built in it
+   and in the scopes around it. Each scope's entries are dropped when it closes: a later scope may
+   reuse its symbols for other variables.
+
+   Sharing is syntactic: two expressions are shared when they are the same text over the same
+   variables, which does not make their values equal. A variable is keyed with the number of
+   assignments to it so far, so x + 1 before and after x = x + 1 are different expressions. A loop
+   runs again after the assignments in its body, so from its head on, expressions built before it
+   are not reused: inside the loop they may not hold the value they had before it. */
+class ExpShapeHash {
+public:
+    size_t operator()(const ExpShape& shape) const {
+        size_t h = shape.kind;
+        for (size_t part : { (size_t)shape.first, (size_t)shape.second, (size_t)shape.detail })
+            h = (h ^ part) * 0x100000001b3ULL;
+        return h;
+    }
+};
+
+class SharedExp {
+public:
+    Exp* exp;
+    size_t order; // Index of its key in shared_order.
+};
+
+static std::unordered_map<ExpShape, SharedExp, ExpShapeHash> shared_exps;
+static vector<ExpShape> shared_order; // Keys of shared_exps, oldest first.
+static vector<size_t> shared_marks;   // Size of shared_order when each open scope opened.
+static vector<size_t> loop_marks;     // Size of shared_order at the head of each open loop.
+static vector<int> assignments_of;     // By symbol, for the keys of variables.
+
+/* ************************************************ */
+static long long assignments_to(int symbol) {
+    return symbol < (int)assignments_of.size() ? assignments_of[symbol] : 0;
+}
+
+/* ************************************************ */
+static void open_shared_scope() {
+    shared_marks.push_back(shared_order.size());
+}
+
+/* ************************************************ */
+static void close_shared_scope() {
+    for (size_t i = shared_marks.back(); i < shared_order.size(); i++)
+        shared_exps.erase(shared_order[i]);
+    shared_order.resize(shared_marks.back());
+    shared_marks.pop_back();
+}
+
+/* ************************************************ */
+static void open_shared_loop() {
+    loop_marks.push_back(shared_order.size());
+}
+
+/* ************************************************ */
+static void close_shared_loop() {
+    loop_marks.pop_back();
+}
+
+/* ************************************************ */
+void begin_function_slice(int func_id) {
+    symbol_stack.clear();
+    scopes.clear();
+    shared_exps.clear();
+    shared_order.clear();
+    shared_marks.clear();
+    loop_marks.clear();
+    assignments_of.clear();
+    num_of_loops = 0;
+    visible_functions = func_id;
+}
+
+/* ************************************************ */
+void reserve_tables(const InputProfile& profile) {
+    functions_table.reserve(profile.functions + 2); // With print and printi.
+    call_graph.reserve(profile.functions + 2);
+    // The global scope, the function's, and one per nested block.
+    scopes.reserve(profile.max_depth + 2);
+    // A declaration is at least three tokens: int x;
+    symbol_stack.reserve(profile.max_params + profile.max_function_tokens / 3);
+    if (body_ir_enabled)
+        current_body.reserve(profile.max_function_tokens);
+}
+
+/* Packed layout: the dumps of a function's scopes wait until the function is complete and its
+   offsets are known. The rows are copied out of the symbol stack as each scope closes. */
+class PendingDump {
+public:
+    int layout_scope;
+    int first_row; // In pending_rows.
+    int num_rows;
+    int depth;
+};
+
+static FrameLayout frame_layout;
+static vector<PendingDump> pending_dumps;
+static vector<SymbolEntry> pending_rows;
+
+/* ************************************************ */
+void reset_analysis() {
+    begin_function_slice(0);
+    functions_table.clear();
+    std::fill(function_of_name.begin(), function_of_name.end(), -1);
+    current_function = 0;
+    pending_dumps.clear();
+    pending_rows.clear();
+    diagnostics.clear();
+    pending_error.str("");
+    errors_recorded = 0;
+    call_graph.clear();
+    clear_pure_bodies();
+    current_body.clear();
+}
+
 /* ************************************************ */
 void create_new_scope() {
-    SymbolTable new_table;
-    tables_stack.push_back(new_table);
-    if (offset_stack.empty())
-        offset_stack.push_back(0);
-    else 
-        offset_stack.push_back(offset_stack.back());
+    if (liveness_enabled && scopes.size() == 1)
+        liveness.begin_function();
+    if (layout_mode == LayoutMode::PACKED && !scopes.empty()) {
+        if (scopes.size() == 1) {
+            frame_layout.begin_function();
+            pending_dumps.clear();
+            pending_rows.clear();
+        } else {
+            frame_layout.open_scope();
+        }
+    }
+    int next_offset = scopes.empty() ? 0 : scopes.back().next_offset;
+    scopes.push_back({ (int)symbol_stack.size(), next_offset });
+    open_shared_scope();
 }
 
 /* ************************************************ */
 void create_global_scope() {
-    SymbolTable new_table;
-    SymbolEntry print_func("print", {"VOID", "STRING"}, 0, true, false, { false });
-    SymbolEntry printi_func("printi", {"VOID", "INT"}, 0, true, false, { false });
-    new_table.rows.push_back(print_func);
-    new_table.rows.push_back(printi_func);
-    tables_stack.push_back(new_table);
-    offset_stack.push_back(0);
+    scopes.push_back({ (int)symbol_stack.size(), 0 });
+    open_shared_scope();
+    if (checking_slices)
+        return;
+    declare_function("print", TypeId::VOID, { TypeId::STRING }, { false });
+    declare_function("printi", TypeId::VOID, { TypeId::INT }, { false });
 }
 
 /* ************************************************ */
-void destroy_current_scope() {
-    endScope();
-    SymbolTable& closed_scope = tables_stack.back();
-    for (auto& row : closed_scope.rows) {
-        if (!row.is_func) 
-            printID(row.name, row.offset, row.types[0]);
-        else {
-            const string return_type = row.types[0];
-            row.types.erase(row.types.begin());
-            printID(row.name, row.offset, makeFunctionType(return_type, row.types));
+/* Per-function results printed after the function's scope dumps. */
+static void append_function_results(string& dump) {
+    if (liveness_enabled)
+        appendLiveSlots(dump, functions_table[current_function].name, liveness.color());
+}
+
+/* ************************************************ */
+static void write_function_dumps() {
+    static string dump;
+    dump.clear();
+    int frame_size = frame_layout.assign_offsets();
+    for (const auto& pending : pending_dumps) {
+        appendEndScope(dump);
+        if (symbol_db)
+            symbol_db->add_scope(current_function, pending.depth);
+        for (int k = 0; k < pending.num_rows; k++) {
+            const SymbolEntry& row = pending_rows[pending.first_row + k];
+            int offset = frame_layout.offset_of(pending.layout_scope, k);
+            appendID(dump, name_of(row.name_id), offset, type_name(row.type), type_name_lengths[idx(row.type)], row.is_const());
+            if (symbol_db)
+                symbol_db->add_symbol(name_of(row.name_id), idx(row.type), offset, row.is_const());
         }
     }
-    tables_stack.pop_back();
-    offset_stack.pop_back();
+    appendFrameSize(dump, functions_table[current_function].name, frame_size);
+    append_function_results(dump);
+    std::cout.write(dump.data(), dump.size());
+    pending_dumps.clear();
+    pending_rows.clear();
 }
 
 /* ************************************************ */
-void check_for_main_correctness() {
-    SymbolTable global_scope = tables_stack.front();
-    int num_of_main = 0;
-    for (const auto& row : global_scope.rows) {
-        if (row.is_func && row.name == "main") {
-            if (row.types[0] == "VOID" && row.types.size() == 1)
-                num_of_main++;
-            else {
-                // Found a function called main with non void return type or params.
-                num_of_main = -1;
-                break;
-            }
-        }
+void destroy_current_scope() {
+    close_shared_scope();
+    const Scope& closed_scope = scopes.back();
+    if (layout_mode == LayoutMode::PACKED && scopes.size() >= 2) {
+        int num_rows = (int)symbol_stack.size() - closed_scope.first_symbol;
+        pending_dumps.push_back({ frame_layout.current_scope(), (int)pending_rows.size(), num_rows, (int)scopes.size() - 1 });
+        pending_rows.insert(pending_rows.end(), symbol_stack.begin() + closed_scope.first_symbol, symbol_stack.end());
+        frame_layout.close_scope();
+        if (scopes.size() == 2)
+            write_function_dumps();
+        symbol_stack.resize(closed_scope.first_symbol);
+        scopes.pop_back();
+        return;
+    }
+    // The whole dump is formatted first and written at once, without flushing per line.
+    static string dump; // Keeps its capacity from scope to scope.
+    dump.clear();
+    appendEndScope(dump);
+    if (symbol_db)
+        symbol_db->add_scope(scopes.size() == 1 ? -1 : current_function, (int)scopes.size() - 1);
+    for (int i = closed_scope.first_symbol; i < (int)symbol_stack.size(); i++) {
+        const SymbolEntry& row = symbol_stack[i];
+        appendID(dump, name_of(row.name_id), row.offset, type_name(row.type), type_name_lengths[idx(row.type)], row.is_const());
+        if (symbol_db)
+            symbol_db->add_symbol(name_of(row.name_id), idx(row.type), row.offset, row.is_const());
+    }
+    if (scopes.size() == 1) {
+        for (const auto& func : functions_table)
+            appendID(dump, func.name, 0, func.type_string->data(), func.type_string->size(), false);
+    } else if (scopes.size() == 2) {
+        append_function_results(dump);
     }
-    if (num_of_main != 1) {
+    std::cout.write(dump.data(), dump.size());
+    symbol_stack.resize(closed_scope.first_symbol);
+    scopes.pop_back();
+}
+
+/* ************************************************ */
+void check_for_main_correctness() {
+    if (checking_slices)
+        return;
+    // Function names are unique, so there is at most one main.
+    int main_id = find_function("main");
+    if (main_id < 0 || functions_table[main_id].ret_type != TypeId::VOID || functions_table[main_id].arity != 0) {
         errorMainMissing();
-        exit(0);
+        semantic_error(INT_MAX);
     }
     destroy_current_scope(); //
+    if (collect_errors)
+        print_diagnostics();
+}
+
+/* ************************************************ */
+SymbolEntry& SymbolRef::entry() const {
+    return symbol_stack[symbol];
 }
 
 /* ************************************************ */
-static bool is_sym_dec(const string& sym, bool is_search_for_func) {
-    for (auto cur_tab = tables_stack.rbegin(); cur_tab != tables_stack.rend(); ++cur_tab) {
-        for (const auto& row : cur_tab->rows) {
-            if (row.name == sym && row.is_func == is_search_for_func)
-                return true;
+SymbolRef resolve(const string& name, SymKind kind) {
+    stats.lookups++;
+    int name_id = find_name(name);
+    if (name_id < 0)
+        return SymbolRef();
+    // Innermost scope first, newest row first.
+    if (kind != SymKind::FUNC) {
+        for (int i = (int)symbol_stack.size() - 1; i >= 0; i--) {
+            stats.rows_scanned++;
+            if (symbol_stack[i].name_id == name_id)
+                return SymbolRef::variable(i);
         }
     }
-    return false;
+    int func_id = function_of_name[name_id];
+    if (kind != SymKind::VAR && func_id >= 0 && func_id < visible_functions)
+        return SymbolRef::function(func_id);
+    return SymbolRef();
+}
+
+/* ************************************************ */
+static void declare_variable(const string& name, TypeId type, int offset, bool is_const) {
+    symbol_stack.push_back(SymbolEntry::variable(intern_name(name), type, offset, is_const));
+    if (layout_mode == LayoutMode::PACKED)
+        frame_layout.add_variable(type, offset < 0);
+    if (liveness_enabled) {
+        int symbol = (int)symbol_stack.size() - 1;
+        if (offset < 0)
+            liveness.declare_param(symbol);
+        else
+            liveness.declare_local(symbol);
+    }
+    if (offset >= 0)
+        call_graph.use_slot(current_function, offset);
+    if (body_ir_enabled)
+        body_declare((int)symbol_stack.size() - 1, type);
+}
+
+/* ************************************************ */
+void print_stats() {
+    std::cerr << "statements: " << stats.statements << std::endl;
+    std::cerr << "lookups: " << stats.lookups << std::endl;
+    std::cerr << "rows scanned: " << stats.rows_scanned << std::endl;
+    if (stats.statements > 0)
+        std::cerr << "rows scanned per statement: " << (double)stats.rows_scanned / stats.statements << std::endl;
+    if (stats.cache_hits + stats.cache_misses > 0) {
+        std::cerr << "cache hits: " << stats.cache_hits << std::endl;
+        std::cerr << "cache misses: " << stats.cache_misses << std::endl;
+    }
+    if (stats.folded_calls > 0)
+        std::cerr << "folded calls: " << stats.folded_calls << std::endl;
+    if (stats.shared_exps > 0)
+        std::cerr << "shared expressions: " << stats.shared_exps << " (" << stats.shared_exps * sizeof(Exp) << " bytes)" << std::endl;
+}
+
+/* ************************************************ */
+bool write_symbol_db(const string& path) {
+    static_assert(sizeof(db_type_names) / sizeof(db_type_names[0]) == NUM_OF_TYPES && idx(TypeId::ERROR) == 5,
+                  "type codes of the symbol database follow TypeId");
+    for (int f = 0; f < (int)functions_table.size(); f++) {
+        const FuncSignature& func = functions_table[f];
+        vector<int> param_types;
+        for (TypeId type : func.param_types)
+            param_types.push_back(idx(type));
+        symbol_db->add_function(func.name, *func.type_string, idx(func.ret_type), param_types, func.const_params,
+                                f < (int)call_graph.callees.size() ? call_graph.callees[f] : vector<int>());
+    }
+    return symbol_db->write(path);
 }
 
 /* Program : Funcs */
@@ -106,334 +556,547 @@ Program::Program() : BaseType("Program") {
 Funcs::Funcs() {
     /*if (strlen(yytext) == 0) {
         errorSyn(yylineno);
-        exit(0);
+        abort_analysis();
     }*/
 }
 
 /* FuncDecl : RetType ID LPAREN Formals RPAREN LBRACE Statements RBRACE */
 FuncDecl::FuncDecl(RetType* return_type, IDWrap* func_name, Formals* params) {
+    if (body_ir_enabled)
+        current_body.clear();
     // Redecleration of function.
-    if (is_sym_dec(func_name->ID, true)) {
+    if (find_function(func_name->ID) >= 0) {
         errorDef(func_name->lineNo, func_name->ID);
-        exit(0);
-    }
-    for (const auto& cur_param : params->formals) {
-        for (const auto& next_param : params->formals) {
-            if (&cur_param == &next_param)
-                continue;
-            // Two parameters with the same name.
-            if (cur_param.token_value == next_param.token_value) {
-                errorDef(func_name->lineNo, cur_param.token_value);
-                exit(0);
-            }
+        semantic_error(func_name->lineNo);
+    }
+    const auto& formals = params->formals;
+    for (int i = 0; i < (int)formals.size(); i++) {
+        // Two parameters with the same name, reported once at the first of them.
+        auto same_name = [&](const FormalDecl& other) { return other.token_value == formals[i].token_value; };
+        if (std::any_of(formals.begin(), formals.begin() + i, same_name))
+            continue;
+        if (std::any_of(formals.begin() + i + 1, formals.end(), same_name)) {
+            errorDef(func_name->lineNo, formals[i].token_value);
+            semantic_error(func_name->lineNo);
         }
     }
-    param_types.push_back(return_type->token_value); // return type first.
-    const_indicator.push_back(false); // Dummy const for return type.
+    vector<TypeId> param_types;
+    vector<bool> const_params;
     for (const auto& param : params->formals) {
         param_types.push_back(param.param_type);
-        const_indicator.push_back(param.is_param_const);
+        const_params.push_back(param.is_param_const);
+    }
+    func_id = declare_function(func_name->ID, return_type->type, param_types, const_params);
+    current_function = func_id;
+    if (body_ir_enabled) {
+        current_body.func_id = func_id;
+        current_body.num_params = (int)formals.size();
     }
-    SymbolEntry new_func(func_name->ID, param_types, 0, true, false, const_indicator);
-    tables_stack.front().rows.push_back(new_func);
     for (const auto& param : params->formals) {
-        int new_offset = --offset_stack.back();
-        vector<string> varType = { param.param_type };
-        tables_stack.back().rows.push_back(SymbolEntry(param.token_value, varType, new_offset, false, param.is_param_const));
+        int new_offset = --scopes.back().next_offset;
+        declare_variable(param.token_value, param.param_type, new_offset, param.is_param_const);
     }
-    offset_stack.back() = 0;
-    current_function_name = func_name->token_value;
+    scopes.back().next_offset = 0;
+}
+
+/* Statements : Statement */
+Statements::Statements(Statement* rhs_statement) {
+    stats.statements++;
+    if (body_ir_enabled && rhs_statement->node >= 0)
+        items.push_back(rhs_statement->node);
+}
+
+/* Statements : Statements Statement */
+Statements::Statements(Statements* rhs_statements, Statement* rhs_statement) : items(std::move(rhs_statements->items)) {
+    stats.statements++;
+    if (body_ir_enabled && rhs_statement->node >= 0)
+        items.push_back(rhs_statement->node);
+}
+
+/* Statement : LBRACE Statements RBRACE */
+Statement::Statement(Statements* rhs_statements) {
+    if (body_ir_enabled)
+        node = current_body.add_block(rhs_statements->items);
+}
+
+/* Statement : Call SC */
+Statement::Statement(Call* call) {
+    count_statement();
+    if (body_ir_enabled && call->node >= 0)
+        node = current_body.add_stmt(StmtOp::CALL, call->node);
 }
 
 /* Statement : BREAK SC */
 /* Statement : CONTINUE SC */
 Statement::Statement(const Break_Cont& type) {
+    count_statement();
+    if (body_ir_enabled)
+        node = current_body.add_stmt(type == Break_Cont::BREAK ? StmtOp::BREAK : StmtOp::CONTINUE);
     if (num_of_loops > 0)
         return;
     if (type == Break_Cont::CONTINUE) {
         errorUnexpectedContinue(yylineno);
-        exit(0);
+        semantic_error(yylineno);
     } else if (type == Break_Cont::BREAK) {
         errorUnexpectedBreak(yylineno);
-        exit(0);
+        semantic_error(yylineno);
+    }
+}
+
+/* ************************************************ */
+static void warn_if_constant(Exp* condition, int lineno) {
+    if (constant_checks && condition->folded && condition->type == TypeId::BOOL) {
+        warnConstantCondition(lineno, condition->value != 0);
+        semantic_warning(lineno);
     }
 }
 
 /* Statement : IF LPAREN Exp RPAREN Statement */
 /* Statement : IF LPAREN Exp RPAREN Statement ELSE Statement */
 /* Statement : WHILE LPAREN Exp RPAREN Statement */
-Statement::Statement(const string& type, Exp* exp) {
-    // Expression inside if/while statement must be boolean.
-    if (exp->type != "BOOL") {
+Statement::Statement(const string& type, Exp* exp, Statement* body, Statement* else_part) {
+    count_statement();
+    if (body_ir_enabled) {
         if (type == "IF")
-            errorMismatch(cur_if_line);
+            node = current_body.add_stmt(StmtOp::IF, exp->node, body->node, else_part ? else_part->node : -1);
         else
-            errorMismatch(cur_while_line);
-        exit(0);
+            node = current_body.add_stmt(StmtOp::WHILE, exp->node, body->node);
+    }
+    // Expression inside if/while statement must be boolean.
+    int lineno = type == "IF" ? cur_if_line : cur_while_line;
+    if (!is_boolean[idx(exp->type)]) {
+        errorMismatch(lineno);
+        semantic_error(lineno);
+    } else if (type == "WHILE") {
+        warn_if_constant(exp, lineno);
     }
 }
 
 /* Statement : RETURN SC */
 Statement::Statement() {
+    count_statement();
+    if (body_ir_enabled)
+        node = current_body.add_stmt(StmtOp::RETURN);
     // Check if current function is void.
-    for (auto cur_tab = tables_stack.rbegin(); cur_tab != tables_stack.rend(); ++cur_tab) {
-        for (const auto& row : cur_tab->rows) {
-            if (row.is_func && row.name == current_function_name) {
-                if (row.types[0] != "VOID") {
-                    errorMismatch(yylineno);
-                    exit(0);
-                }
-                return;
-            }
-        }
+    if (functions_table[current_function].ret_type != TypeId::VOID) {
+        errorMismatch(yylineno);
+        semantic_error(yylineno);
     }
 }
 
 /* Statement : RETURN Exp SC */
 Statement::Statement(Exp* exp) {
-    for (auto cur_tab = tables_stack.rbegin(); cur_tab != tables_stack.rend(); ++cur_tab) {
-        for (const auto& row : cur_tab->rows) {
-            if (!row.is_func || row.name != current_function_name) 
-                continue;
-            if (row.types[0] == "VOID") {
-                // Return something from void func.
-                errorMismatch(yylineno);
-                exit(0);
-            }
-            if (row.types[0] != exp->type) {
-                if (row.types[0] == "INT" && exp->type == "BYTE")
-                    return;
-                else {
-                    // Return int from bool func.
-                    errorMismatch(yylineno);
-                    exit(0);
-                }
-            }
-            return;
-        }
+    count_statement();
+    if (body_ir_enabled)
+        node = current_body.add_stmt(StmtOp::RETURN, exp->node);
+    TypeId ret_type = functions_table[current_function].ret_type;
+    if (ret_type == TypeId::VOID) {
+        // Return something from void func.
+        errorMismatch(yylineno);
+        semantic_error(yylineno);
+    } else if (!assignable[idx(ret_type)][idx(exp->type)]) {
+        // Return int from bool func.
+        errorMismatch(yylineno);
+        semantic_error(yylineno);
     }
 }
 
 /* Statement : ID ASSIGN Exp SC */
 Statement::Statement(BaseType* id, Exp* exp) {
+    count_statement();
+    SymbolRef var = resolve(id->token_value, SymKind::VAR);
     // Assignment to undeclared var.
-    if (!is_sym_dec(id->token_value, false)) {
+    if (!var.found()) {
         errorUndef(yylineno, id->token_value);
-        exit(0);
-    }
-
-    for (auto cur_tab = tables_stack.rbegin(); cur_tab != tables_stack.rend(); ++cur_tab) {
-        for (const auto& row : cur_tab->rows) {
-            if (!row.is_func && row.name == id->token_value) {
-                // We found the desired variable
-                if (row.is_const) {
-                    errorConstMismatch(yylineno);
-                    exit(0);
-                }
-                if (row.types[0] == exp->type)
-                    return;
-                if (row.types[0] == "INT" && exp->type == "BYTE")
-                    return;
-                errorMismatch(yylineno);
-                exit(0);
-            }
-        }
+        semantic_error(yylineno);
+        return;
+    }
+    if (liveness_enabled)
+        liveness.reference(var.symbol);
+    if (var.symbol >= (int)assignments_of.size())
+        assignments_of.resize(var.symbol + 1, 0);
+    assignments_of[var.symbol]++;
+    if (body_ir_enabled)
+        node = current_body.add_stmt(StmtOp::ASSIGN, body_var_of(var.symbol), exp->node);
+    const SymbolEntry& row = var.entry();
+    if (row.is_const()) {
+        errorConstMismatch(yylineno);
+        semantic_error(yylineno);
+    } else if (!assignable[idx(row.type)][idx(exp->type)]) {
+        errorMismatch(yylineno);
+        semantic_error(yylineno);
     }
 }
 
 /* Statement : TypeAnnotation Type ID ASSIGN Exp SC */
 Statement::Statement(Type* type, BaseType* id, Exp* exp, TypeAnnotation* const_anno) {
+    count_statement();
     // Symbol redefinition.
-    if (is_sym_dec(id->token_value, true) || is_sym_dec(id->token_value, false)) {
+    if (resolve(id->token_value, SymKind::ANY).found()) {
         errorDef(yylineno, id->token_value);
-        exit(0);
+        semantic_error(yylineno);
+        return;
     }
-    if (type->token_value == exp->type || (type->token_value == "INT" && exp->type == "BYTE")) {
-        int new_offset = offset_stack.back()++;
-        vector<string> varType = { type->token_value };
-        SymbolEntry new_sym(id->token_value, varType, new_offset, false, const_anno->is_const);
-        tables_stack.back().rows.push_back(new_sym);
-    } else {
+    if (!assignable[idx(type->type)][idx(exp->type)]) {
         errorMismatch(yylineno);
-        exit(0);
+        semantic_error(yylineno);
     }
+    // Declared even after a mismatch, so later uses are not reported as undefined.
+    int new_offset = scopes.back().next_offset++;
+    declare_variable(id->token_value, type->type, new_offset, const_anno->is_const);
+    if (body_ir_enabled)
+        node = current_body.add_stmt(StmtOp::DECL, body_var_of((int)symbol_stack.size() - 1), exp->node);
 }
 
 /* Statement : TypeAnnotation Type ID SC */
 Statement::Statement(Type* type, BaseType* id, TypeAnnotation* const_anno) {
+    count_statement();
     // Symbol redefinition.
-    if (is_sym_dec(id->token_value, true) || is_sym_dec(id->token_value, false)) {
+    if (resolve(id->token_value, SymKind::ANY).found()) {
         errorDef(yylineno, id->token_value);
-        exit(0);
+        semantic_error(yylineno);
+        return;
     }
     if (const_anno->is_const) {
         errorConstDef(yylineno);
-        exit(0);
+        semantic_error(yylineno);
     }
-    int new_offset = offset_stack.back()++;
-    vector<string> varType = { type->token_value };
-    SymbolEntry new_sym(id->token_value, varType, new_offset, false, false);
-    tables_stack.back().rows.push_back(new_sym);
+    int new_offset = scopes.back().next_offset++;
+    declare_variable(id->token_value, type->type, new_offset, false);
+    if (body_ir_enabled)
+        node = current_body.add_stmt(StmtOp::DECL, body_var_of((int)symbol_stack.size() - 1));
+}
+
+/* ************************************************ */
+/* Returns nullptr after reporting an undefined function. */
+static const FuncSignature* resolve_called_function(BaseType* id) {
+    int func_id = find_function(id->token_value);
+    if (func_id < 0) {
+        errorUndefFunc(yylineno, id->token_value);
+        semantic_error(yylineno);
+        return nullptr;
+    }
+    call_graph.add_call(current_function, func_id, loop_weight());
+    return &functions_table[func_id];
+}
+
+/* ************************************************ */
+static int add_call_node(const FuncSignature* func, const vector<Exp*>& args) {
+    int func_id = (int)(func - functions_table.data());
+    int node = current_body.add_exp(ExpOp::CALL, func->ret_type, func_id, (int)current_body.call_args.size());
+    current_body.exps[node].count = (int)args.size();
+    for (Exp* arg : args)
+        current_body.call_args.push_back(arg->node);
+    return node;
+}
+
+/* ************************************************ */
+void Call::fold_call(const FuncSignature* func, const vector<Exp*>& args) {
+    vector<int> values;
+    for (Exp* arg : args) {
+        if (!arg->folded)
+            return;
+        values.push_back(arg->value);
+    }
+    folded = evaluate_call((int)(func - functions_table.data()), values, value);
 }
 
 /* Call : ID LPAREN ExpList RPAREN */
 Call::Call(BaseType* id, ExpList* param_list) {
-    for (auto& table : tables_stack) {
-        for (auto& row : table.rows) {
-            if (row.name != id->token_value)
-                continue;
-            // Found variable with a func name.
-            if (!row.is_func) {
-                errorUndefFunc(yylineno, id->token_value);
-                exit(0);
-            }
-            // Incorrect number of parameters.
-            if (row.types.size() != param_list->list.size() + 1) {
-                row.types.erase(row.types.begin()); // Remove return type.
-                errorPrototypeMismatch(yylineno, id->token_value, row.types);
-                exit(0);
-            }
-            for (int i = 0; i < param_list->list.size(); i++) {
-                if (param_list->list[i]->type == row.types[i + 1])
-                    continue;
-                if (param_list->list[i]->type == "BYTE" && row.types[i + 1] == "INT")
-                    continue;
-                row.types.erase(row.types.begin());
-                errorPrototypeMismatch(yylineno, id->token_value, row.types);
-                exit(0);
-            }
-            ret_type_of_called_func = row.types[0];
-            return; // Everything is fine.
-        }
+    const FuncSignature* func = resolve_called_function(id);
+    if (!func) {
+        ret_type_of_called_func = TypeId::ERROR;
+        return;
     }
-    errorUndefFunc(yylineno, id->token_value);
-    exit(0);
+    // Incorrect number of parameters.
+    bool matches = func->arity == (int)param_list->list.size();
+    for (int i = 0; matches && i < func->arity; i++)
+        matches = assignable[idx(func->param_types[i])][idx(param_list->list[i]->type)];
+    if (!matches) {
+        errorPrototypeMismatch(yylineno, id->token_value, *func->args_string);
+        semantic_error(yylineno);
+    } else {
+        if (body_ir_enabled)
+            node = add_call_node(func, param_list->list);
+        if (eval_calls)
+            fold_call(func, param_list->list);
+    }
+    ret_type_of_called_func = func->ret_type;
 }
 
 /* Call : ID LPAREN RPAREN */
 Call::Call(BaseType* id) {
-    for (auto& table : tables_stack) {
-        for (auto& row : table.rows) {
-            if (row.name != id->token_value)
-                continue;
-            // Found variable with a func name.
-            if (!row.is_func) {
-                errorUndefFunc(yylineno, id->token_value);
-                exit(0);
-            }
-            // Incorrect number of parameters.
-            if (row.types.size() != 1) {
-                row.types.erase(row.types.begin()); // Remove return type.
-                errorPrototypeMismatch(yylineno, id->token_value, row.types);
-                exit(0);
-            }
-            ret_type_of_called_func = row.types[0];
-            return; // Everything is fine.
-        }
+    const FuncSignature* func = resolve_called_function(id);
+    if (!func) {
+        ret_type_of_called_func = TypeId::ERROR;
+        return;
     }
-    errorUndefFunc(yylineno, id->token_value);
-    exit(0);
+    // Incorrect number of parameters.
+    if (func->arity != 0) {
+        errorPrototypeMismatch(yylineno, id->token_value, *func->args_string);
+        semantic_error(yylineno);
+    } else {
+        if (body_ir_enabled)
+            node = add_call_node(func, {});
+        if (eval_calls)
+            fold_call(func, {});
+    }
+    ret_type_of_called_func = func->ret_type;
 }
 
 /* Exp : Call */
 Exp::Exp(Call* call) {
     token_value = call->token_value;
     type = call->ret_type_of_called_func;
+    folded = call->folded;
+    value = call->value;
+    if (body_ir_enabled && folded)
+        node = current_body.add_exp(ExpOp::CONST, type, value);
+    else if (body_ir_enabled)
+        node = call->node >= 0 ? call->node : current_body.add_exp(ExpOp::OTHER, type);
 }
 
 /* Exp : ID */
 Exp::Exp(BaseType* term) {
-    if (!is_sym_dec(term->token_value, false)) {
+    SymbolRef var = resolve(term->token_value, SymKind::VAR);
+    token_value = term->token_value;
+    if (!var.found()) {
         errorUndef(yylineno, term->token_value);
-        exit(0);
-    }
-
-    for (const auto& table : tables_stack) {
-        for (const auto& row : table.rows) {
-            if (row.name == term->token_value) {
-                token_value = term->token_value;
-                type = row.types[0];
-                return;
-            }
-        }
+        semantic_error(yylineno);
+        type = TypeId::ERROR;
+        if (body_ir_enabled)
+            node = current_body.add_exp(ExpOp::OTHER, type);
+        return;
     }
+    if (liveness_enabled)
+        liveness.reference(var.symbol);
+    type = var.entry().type;
+    shape = { ExpShape::VAR, nullptr, nullptr, assignments_to(var.symbol) << 32 | var.symbol };
+    if (body_ir_enabled)
+        node = current_body.add_exp(ExpOp::VAR, type, body_var_of(var.symbol));
 }
 
 /* Exp : NOT Exp */
 Exp::Exp(bool not_mark, Exp* exp) {
     // Not performed on something wich is not boolean.
-    if (exp->type != "BOOL") {
+    if (!is_boolean[idx(exp->type)]) {
         errorMismatch(yylineno);
-        exit(0);
+        semantic_error(yylineno);
     }
-    type = "BOOL";
+    type = TypeId::BOOL;
+    folded = exp->folded;
+    value = !exp->value;
+    shape = { ExpShape::NOT, exp };
+    if (body_ir_enabled)
+        node = current_body.add_exp(ExpOp::NOT, type, exp->node);
 }
 
 /*  Exp : NUM, NUM B, STRING, TRUE, FALSE */
-Exp::Exp(BaseType* term, const string& rhs) : BaseType(term->token_value) {
-    if (rhs == "BYTE") {
-        if (stoi(term->token_value) > 255) {
+Exp::Exp(BaseType* term, TypeId rhs) : BaseType(term->token_value) {
+    type = rhs;
+    if (rhs == TypeId::INT || rhs == TypeId::BYTE) {
+        // Saturates on huge literals, which are out of range for a byte either way.
+        long long literal = strtoll(term->token_value.c_str(), nullptr, 10);
+        if (rhs == TypeId::BYTE && literal > 255) {
             errorByteTooLarge(yylineno, term->token_value);
-            exit(0);
+            semantic_error(yylineno);
         }
+        folded = true;
+        value = wrap_int(literal);
+    } else if (rhs == TypeId::BOOL) {
+        folded = true;
+        value = term->token_value == "true";
     }
-    type = rhs;
+    if (folded)
+        shape = { ExpShape::LITERAL, nullptr, nullptr, (long long)idx(type) << 32 | (unsigned int)value };
+    if (body_ir_enabled)
+        node = folded ? current_body.add_exp(ExpOp::CONST, type, value) : current_body.add_exp(ExpOp::OTHER, type);
 }
 
 /* Exp : LPAREN Exp RPAREN */
 Exp::Exp(Exp* exp) {
     token_value = exp->token_value;
     type = exp->type;
+    folded = exp->folded;
+    value = exp->value;
+    node = exp->node;
+    // Parentheses do not change the shape, so share() hands back exp itself.
+    shape = exp->shape;
+}
+
+/* Value of first op second, in 64 bits so the caller sees overflow. Returns false on division by zero. */
+static bool fold_arith(long long first, char op, long long second, long long& result) {
+    switch (op) {
+        case '+': result = first + second; return true;
+        case '-': result = first - second; return true;
+        case '*': result = first * second; return true;
+        default:
+            if (second == 0)
+                return false;
+            result = first / second;
+            return true;
+    }
+}
+
+/* ************************************************ */
+static bool fold_relop(int first, const string& op, int second) {
+    if (op == "==") return first == second;
+    if (op == "!=") return first != second;
+    if (op == "<") return first < second;
+    if (op == ">") return first > second;
+    if (op == "<=") return first <= second;
+    return first >= second;
+}
+
+/* ************************************************ */
+void Exp::fold(Exp* first, const OP_TYPE& op, Exp* second, const string& op_text) {
+    if (type == TypeId::ERROR)
+        return;
+    if (op == OP_TYPE::AND || op == OP_TYPE::OR) {
+        // false and x, true or x: known from the left operand alone.
+        bool short_circuit = op == OP_TYPE::OR;
+        if (first->folded && (first->value != 0) == short_circuit) {
+            folded = true;
+            value = short_circuit;
+        } else if (first->folded && second->folded) {
+            folded = true;
+            value = second->value != 0;
+        }
+        return;
+    }
+    if (!first->folded || !second->folded) {
+        if (constant_checks && op_text == "/" && second->folded && second->value == 0) {
+            errorDivByZero(yylineno);
+            semantic_error(yylineno);
+        }
+        return;
+    }
+    if (op == OP_TYPE::EQUALITY || op == OP_TYPE::RELATION) {
+        folded = true;
+        value = fold_relop(first->value, op_text, second->value);
+        return;
+    }
+    long long result;
+    if (!fold_arith(first->value, op_text[0], second->value, result)) {
+        if (constant_checks) {
+            errorDivByZero(yylineno);
+            semantic_error(yylineno);
+        }
+        return;
+    }
+    if (type == TypeId::BYTE && (result < 0 || result > 255)) {
+        if (constant_checks) {
+            errorByteTooLarge(yylineno, std::to_string(result));
+            semantic_error(yylineno);
+        }
+        result &= 0xff;
+    }
+    folded = true;
+    value = wrap_int(result);
+}
+
+/* ************************************************ */
+static ExpOp exp_op_of(const string& op_text) {
+    static const std::pair<const char*, ExpOp> ops[] = {
+        { "and", ExpOp::AND }, { "or", ExpOp::OR }, { "+", ExpOp::ADD }, { "-", ExpOp::SUB }, { "*", ExpOp::MUL },
+        { "/", ExpOp::DIV }, { "==", ExpOp::EQ }, { "!=", ExpOp::NE }, { "<", ExpOp::LT }, { ">", ExpOp::GT },
+        { "<=", ExpOp::LE }, { ">=", ExpOp::GE }
+    };
+    for (const auto& op : ops) {
+        if (op_text == op.first)
+            return op.second;
+    }
+    return ExpOp::OTHER;
 }
 
 /* Exp : Exp RELOP/BINOP Exp */
-Exp::Exp(Exp* first, const OP_TYPE& op, Exp* second) {
+Exp::Exp(Exp* first, const OP_TYPE& op, Exp* second, BaseType* op_token) {
     if (op == OP_TYPE::BINADD || op == OP_TYPE::BINMUL) {
-        // Byte BINOP Byte <- Byte
-        if (first->type == "BYTE" && second->type == "BYTE")
-            type = "BYTE";
-        // Byte\Int BINOP Byte\Int <- Int
-        else if ((first->type == "INT" || first->type == "BYTE") && (second->type == "INT" || second->type == "BYTE"))
-            type = "INT";
+        // Byte BINOP Byte <- Byte, Byte\Int BINOP Byte\Int <- Int
+        type = arith_result[idx(first->type)][idx(second->type)];
         // BINOP on non number types.
-        else {
+        if (type == TypeId::VOID) {
             errorMismatch(yylineno);
-            exit(0);
+            semantic_error(yylineno);
+            type = TypeId::ERROR;
         }
     }
     else if (op == OP_TYPE::EQUALITY || op == OP_TYPE::RELATION) {
         // RELOP on non number types.
-        if ((first->type != "INT" && first->type != "BYTE") || (second->type != "INT" && second->type != "BYTE")) {
+        if (!is_numeric[idx(first->type)] || !is_numeric[idx(second->type)]) {
             errorMismatch(yylineno);
-            exit(0);
+            semantic_error(yylineno);
         }
-        type = "BOOL";
+        type = TypeId::BOOL;
     }
     else if (op == OP_TYPE::AND || op == OP_TYPE::OR) {
         // AND\OR on non bool types.
-        if (first->type != "BOOL" || second->type != "BOOL") {
+        if (!is_boolean[idx(first->type)] || !is_boolean[idx(second->type)]) {
             errorMismatch(yylineno);
-            exit(0);
+            semantic_error(yylineno);
         }
-        type = "BOOL";
+        type = TypeId::BOOL;
     }
+    fold(first, op, second, op_token->token_value);
+    // Every operator is at most three characters long (and).
+    long long op_code = 0;
+    for (int i = 0; i < 3 && i < (int)op_token->token_value.size(); i++)
+        op_code |= (long long)(unsigned char)op_token->token_value[i] << (8 * i);
+    shape = { ExpShape::BINOP, first, second, op_code };
+    if (body_ir_enabled)
+        node = current_body.add_exp(type == TypeId::ERROR ? ExpOp::OTHER : exp_op_of(op_token->token_value), type, first->node, second->node);
 }
 
 // Exp : LPAREN Type RPAREN Exp
 Exp::Exp(Type* new_type, Exp* exp) {
-    if (new_type->token_value == "BYTE" || new_type->token_value == "INT") {
-        if (exp->type == "BYTE" || exp->type == "INT") {
-            type = new_type->token_value;
-            return;
-        }
+    if (!castable[idx(new_type->type)][idx(exp->type)]) {
+        errorMismatch(yylineno);
+        semantic_error(yylineno);
     }
-    errorMismatch(yylineno);
-    exit(0);
+    type = new_type->type;
+    // A cast to byte keeps the low 8 bits.
+    folded = exp->folded && exp->type != TypeId::ERROR;
+    value = type == TypeId::BYTE ? exp->value & 0xff : exp->value;
+    shape = { ExpShape::CAST, exp, nullptr, idx(type) };
+    if (body_ir_enabled)
+        node = current_body.add_exp(ExpOp::CAST, type, exp->node);
 }
 
-void checkBoolExp(Exp* exp){
-    if(exp->type != "BOOL") {
+/* ************************************************ */
+Exp* Exp::share(Exp* exp) {
+    // Expressions with errors stay apart: --all-errors reports each of them.
+    if (exp->shape.kind == ExpShape::NONE || exp->type == TypeId::ERROR)
+        return exp;
+    auto found = shared_exps.find(exp->shape);
+    size_t loop_mark = loop_marks.empty() ? 0 : loop_marks.back();
+    if (found == shared_exps.end() || found->second.order < loop_mark) {
+        // Inside a loop, an expression from before it is replaced until the loop's scope closes.
+        shared_exps[exp->shape] = { exp, shared_order.size() };
+        shared_order.push_back(exp->shape);
+        return exp;
+    }
+    Exp* existing = found->second.exp;
+    if (existing == exp)
+        return exp;
+    // Every occurrence keeps the body node it added, so analyses of the body see it at its own line.
+    // The parent built next reads the node from the shared expression.
+    if (body_ir_enabled)
+        existing->node = exp->node;
+    stats.shared_exps++;
+    delete exp;
+    return existing;
+}
+
+/* ************************************************ */
+Exp* checkBoolExp(Exp* exp) {
+    if (!is_boolean[idx(exp->type)]) {
         errorMismatch(yylineno);
-        exit(0);
+        semantic_error(yylineno);
+        // Already reported; keeps the if statement from reporting it again.
+        Exp* reported = new Exp(*exp);
+        reported->type = TypeId::ERROR;
+        return reported;
     }
+    warn_if_constant(exp, yylineno);
+    return exp;
 }
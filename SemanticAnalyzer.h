@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <type_traits>
 #include "hw3_output.hpp"
 #include <iostream>
 
@@ -11,12 +13,50 @@ using std::string;
 
 void loop_entered();
 void loop_exited();
+void loop_head_reached();
 void enter_if();
 void create_new_scope();
 void create_global_scope();
 void destroy_current_scope();
 void check_for_main_correctness();
 
+/* Thrown by abort_analysis() when throw_on_error is set. */
+struct AnalysisAborted {};
+
+/* Called right after an error was printed. Ends the process, or throws AnalysisAborted when
+   throw_on_error is set so the driver can carry on with other work. */
+[[noreturn]] void abort_analysis();
+extern bool throw_on_error;
+
+/* Multi-diagnostic mode: semantic errors are recorded and the analysis carries on, with
+   TypeId::ERROR standing in for expressions whose type could not be determined. */
+extern bool collect_errors;
+
+/* Turns on multi-diagnostic mode; at most max_errors errors are printed. */
+void collect_diagnostics(int max_errors);
+
+/* Semantic errors recorded in multi-diagnostic mode since the last reset_analysis(). */
+extern int errors_recorded;
+
+/* Called right after a semantic error at lineno was printed. Acts as abort_analysis(), unless errors
+   are being collected: then the error is recorded and the caller recovers. */
+void semantic_error(int lineno);
+
+/* Called right after a lexical or syntax error was printed. These always end the analysis. */
+[[noreturn]] void fatal_error(int lineno);
+
+/* Called right after a warning was printed; it is recorded like an error when collecting. */
+void semantic_warning(int lineno);
+
+/* Prints the recorded errors sorted by line. */
+void print_diagnostics();
+
+/* Reports errors in constant expressions (byte overflow, division by zero) and constant conditions. */
+extern bool constant_checks;
+
+/* Called by the scanner on a character no token matches; returns the token to hand the parser. */
+int lexical_error();
+
 enum class OP_TYPE {
     EQUALITY,
     RELATION,
@@ -31,6 +71,68 @@ enum class Break_Cont {
     CONTINUE
 };
 
+/* One byte per type. Strings are produced only when printing (see type_name). */
+enum class TypeId : unsigned char {
+    VOID,
+    BOOL,
+    INT,
+    BYTE,
+    STRING,
+    ERROR   // Poison: the expression already caused an error. Accepted everywhere, so it reports nothing new.
+};
+
+constexpr int NUM_OF_TYPES = 6;
+
+constexpr int idx(TypeId t) { return static_cast<int>(t); }
+
+constexpr const char* type_names[NUM_OF_TYPES] = { "VOID", "BOOL", "INT", "BYTE", "STRING", "ERROR" };
+constexpr unsigned char type_name_lengths[NUM_OF_TYPES] = { 4, 4, 3, 4, 6, 5 };
+
+/* Result type of BINOP, indexed [lhs][rhs]. VOID marks an illegal operand pair. */
+constexpr TypeId arith_result[NUM_OF_TYPES][NUM_OF_TYPES] = {
+    /*   rhs:    VOID           BOOL           INT            BYTE           STRING         ERROR */
+    /* VOID   */ { TypeId::VOID,  TypeId::VOID,  TypeId::VOID,  TypeId::VOID,  TypeId::VOID,  TypeId::ERROR },
+    /* BOOL   */ { TypeId::VOID,  TypeId::VOID,  TypeId::VOID,  TypeId::VOID,  TypeId::VOID,  TypeId::ERROR },
+    /* INT    */ { TypeId::VOID,  TypeId::VOID,  TypeId::INT,   TypeId::INT,   TypeId::VOID,  TypeId::ERROR },
+    /* BYTE   */ { TypeId::VOID,  TypeId::VOID,  TypeId::INT,   TypeId::BYTE,  TypeId::VOID,  TypeId::ERROR },
+    /* STRING */ { TypeId::VOID,  TypeId::VOID,  TypeId::VOID,  TypeId::VOID,  TypeId::VOID,  TypeId::ERROR },
+    /* ERROR  */ { TypeId::ERROR, TypeId::ERROR, TypeId::ERROR, TypeId::ERROR, TypeId::ERROR, TypeId::ERROR },
+};
+
+/* Can a value of type [from] be stored in a slot of type [to] (assignment, return, argument). */
+constexpr bool assignable[NUM_OF_TYPES][NUM_OF_TYPES] = {
+    /*   from:   VOID   BOOL   INT    BYTE   STRING ERROR */
+    /* VOID   */ { false, false, false, false, false, true },
+    /* BOOL   */ { false, true,  false, false, false, true },
+    /* INT    */ { false, false, true,  true,  false, true },
+    /* BYTE   */ { false, false, false, true,  false, true },
+    /* STRING */ { false, false, false, false, true,  true },
+    /* ERROR  */ { true,  true,  true,  true,  true,  true },
+};
+
+/* Is LPAREN [to] RPAREN Exp:[from] legal. */
+constexpr bool castable[NUM_OF_TYPES][NUM_OF_TYPES] = {
+    /*   from:   VOID   BOOL   INT    BYTE   STRING ERROR */
+    /* VOID   */ { false, false, false, false, false, true },
+    /* BOOL   */ { false, false, false, false, false, true },
+    /* INT    */ { false, false, true,  true,  false, true },
+    /* BYTE   */ { false, false, true,  true,  false, true },
+    /* STRING */ { false, false, false, false, false, true },
+    /* ERROR  */ { true,  true,  true,  true,  true,  true },
+};
+
+/* Operands of RELOP/EQUALITY. */
+constexpr bool is_numeric[NUM_OF_TYPES] = { false, false, true, true, false, true };
+
+/* Operands of NOT/AND/OR and if/while conditions. */
+constexpr bool is_boolean[NUM_OF_TYPES] = { false, true, false, false, false, true };
+
+static_assert(arith_result[idx(TypeId::BYTE)][idx(TypeId::BYTE)] == TypeId::BYTE, "byte BINOP byte is byte");
+static_assert(assignable[idx(TypeId::INT)][idx(TypeId::BYTE)] && !assignable[idx(TypeId::BYTE)][idx(TypeId::INT)], "only byte widens to int");
+static_assert(arith_result[idx(TypeId::BOOL)][idx(TypeId::ERROR)] == TypeId::ERROR, "poison propagates without a new error");
+
+inline const char* type_name(TypeId t) { return type_names[idx(t)]; }
+
 class BaseType {
 public:
     BaseType() { token_value = ""; }
@@ -51,29 +153,137 @@ public:
 };
 
 #define YYSTYPE BaseType*
+// A plain pointer, so the parser may grow its stack past YYINITDEPTH for deeply nested blocks.
+#define YYSTYPE_IS_TRIVIAL 1
 
-class SymbolEntry {
-public:
-    string name;
-    vector<string> types;
-    vector<bool> cost_indicator;
+/* Identifier names are interned once; symbols refer to them by id. */
+int intern_name(const string& name);
+/* Id of an interned name, or -1 if the name was never declared. */
+int find_name(const string& name);
+const string& name_of(int name_id);
+
+enum SymbolFlags : unsigned char {
+    SYM_CONST = 1
+};
+
+/* Plain 12 byte record of a variable. Functions live in functions_table. */
+struct SymbolEntry {
+    int name_id;
     int offset;
-    bool is_func;
-    bool is_const;
-    SymbolEntry(const string& name, const vector<string>& types, int offset, bool is_func, bool is_const, const vector<bool>& const_indicator = {}) :
-        name(name), types(types), cost_indicator(cost_indicator), offset(offset), is_func(is_func), is_const(is_const) {}
+    TypeId type;
+    unsigned char flags;
+
+    bool is_const() const { return flags & SYM_CONST; }
+
+    static SymbolEntry variable(int name_id, TypeId type, int offset, bool is_const) {
+        SymbolEntry entry;
+        entry.name_id = name_id;
+        entry.offset = offset;
+        entry.type = type;
+        entry.flags = is_const ? SYM_CONST : 0;
+        return entry;
+    }
+};
+
+static_assert(std::is_trivially_copyable<SymbolEntry>::value, "symbols are copied as raw bytes");
+static_assert(sizeof(SymbolEntry) == 12, "keep symbols compact");
+
+/* Watermark of an open scope in the symbol stack. */
+struct Scope {
+    int first_symbol; // Index in the symbol stack of the scope's first variable.
+    int next_offset;  // Offset of the next variable declared in the scope.
+};
+
+enum class SymKind {
+    VAR,
+    FUNC,
+    ANY
 };
 
-class SymbolTable {
+/* Handle to a binding returned by resolve(): a variable's index in the symbol stack or a function id.
+   Holds indices, so it stays valid while the stack grows. */
+class SymbolRef {
 public:
-    vector<SymbolEntry> rows;
+    int symbol = -1;
+    int func_id = -1;
+    SymbolRef() = default;
+    static SymbolRef variable(int symbol) { SymbolRef ref; ref.symbol = symbol; return ref; }
+    static SymbolRef function(int func_id) { SymbolRef ref; ref.func_id = func_id; return ref; }
+    bool found() const { return symbol >= 0 || func_id >= 0; }
+    SymbolEntry& entry() const;
 };
 
-class Type : public BaseType {
+/* Signature of a declared function, formatted once when it is declared. */
+class FuncSignature {
 public:
-    explicit Type(BaseType* type) : BaseType(type->token_value) {
+    string name;
+    TypeId ret_type;
+    int arity;
+    vector<TypeId> param_types;
+    vector<bool> const_params;
+    const string* args_string; // "(INT,BYTE)", for prototype mismatch errors.
+    const string* type_string; // "(INT,BYTE)->VOID", for scope dumps.
+    FuncSignature(const string& name, TypeId ret_type, const vector<TypeId>& param_types, const vector<bool>& const_params);
+};
 
-    }
+/* The signature table: argument lists and function types, each formatted once and shared by every
+   function with the same one. The strings stay where they are until exit. */
+const string* intern_args_string(const vector<TypeId>& param_types);
+const string* intern_type_string(TypeId ret_type, const vector<TypeId>& param_types);
+
+/* All declared functions in declaration order; the global scope. */
+extern vector<FuncSignature> functions_table;
+
+/* Id of the function called name, or -1. Only the first visible_functions functions are seen. */
+int find_function(const string& name);
+extern int visible_functions;
+
+/* Adds a signature without checking it or making it visible. Used by the two-phase driver to
+   declare every function, in declaration order, before any body is checked. */
+int register_function(const string& name, TypeId ret_type, const vector<TypeId>& param_types, const vector<bool>& const_params);
+
+/* Two-phase mode: all signatures are registered up front and the parser is fed one function at a
+   time. FuncDecl then takes the next registered id instead of declaring, and the global scope is
+   neither populated nor checked for main. */
+extern bool checking_slices;
+
+/* Clears the scopes before checking the body of function func_id in two-phase mode. */
+void begin_function_slice(int func_id);
+
+/* Forgets everything about the input analyzed last, also after an aborted analysis, so the next one
+   starts from scratch. Interned names and signatures are kept. Used by the batch driver. */
+void reset_analysis();
+
+/* Reserves the function table, the scopes, the symbol stack and the node pools for an input with
+   the given profile (see Prescan.h), so they do not reallocate while the input is parsed. */
+class InputProfile;
+void reserve_tables(const InputProfile& profile);
+
+/* Single innermost-to-outermost lookup of name among symbols of the given kind. */
+SymbolRef resolve(const string& name, SymKind kind);
+
+/* Counters reported by --stats. */
+struct AnalyzerStats {
+    long statements = 0;
+    long lookups = 0;
+    long rows_scanned = 0;
+    long cache_hits = 0;   // Function bodies taken from the --cache file.
+    long cache_misses = 0;
+    long folded_calls = 0; // Calls evaluated by --eval-calls.
+    long shared_exps = 0;  // Expressions found already built by Exp::share.
+};
+
+extern AnalyzerStats stats;
+void print_stats();
+
+/* Adds the functions, their signatures and their calls to the --symbol-db records and writes the file. */
+bool write_symbol_db(const string& path);
+
+class Type : public BaseType {
+public:
+    TypeId type;
+    // INT, BYTE, BOOL
+    Type(BaseType* type, TypeId id) : BaseType(type->token_value), type(id) {}
 };
 
 class Program : public BaseType {
@@ -90,10 +300,11 @@ public:
 
 class RetType : public BaseType {
 public:
+    TypeId type;
     // TYPE
-    explicit RetType(BaseType* type) : BaseType(type->token_value) {
-
-    }
+    explicit RetType(Type* type) : BaseType(type->token_value), type(type->type) {}
+    // VOID
+    explicit RetType(BaseType* type) : BaseType(type->token_value), type(TypeId::VOID) {}
 };
 
 class IDWrap : public BaseType {
@@ -116,11 +327,11 @@ public:
 
 class FormalDecl : public BaseType {
 public:
-    string param_type;
+    TypeId param_type;
     bool is_param_const;
     // Type ID
     FormalDecl(Type* t, IDWrap* id, TypeAnnotation* const_anno) :
-        BaseType(id->ID), param_type(t->token_value), is_param_const(const_anno->is_const) {}
+        BaseType(id->ID), param_type(t->type), is_param_const(const_anno->is_const) {}
 };
 
 class FormalsList : public BaseType {
@@ -148,19 +359,38 @@ public:
 
 class FuncDecl : public BaseType {
 public:
-    vector<string> param_types;
-    vector<bool> const_indicator;
+    int func_id;
     // RetType ID LPAREN Formals RPAREN LBRACE Statements RBRACE
     FuncDecl(RetType* return_type, IDWrap* func_name, Formals* params);
 };
 
 class Call; 
+class Exp;
+
+/* What an expression applies to what, for hash-consing. Operands are shared already, so comparing
+   their addresses compares them structurally. */
+class ExpShape {
+public:
+    enum Kind : unsigned char { NONE, LITERAL, VAR, NOT, BINOP, CAST };
+    Kind kind = NONE; // NONE: never shared (calls, strings).
+    const Exp* first = nullptr;
+    const Exp* second = nullptr;
+    long long detail = 0; // LITERAL: type and value. VAR: symbol and assignments to it. BINOP: operator text. CAST: type.
+    bool operator==(const ExpShape& other) const {
+        return kind == other.kind && first == other.first && second == other.second && detail == other.detail;
+    }
+};
 
 class Exp : public BaseType {
 public:
-    string type;
+    TypeId type;
+    // Set when the value is known at compile time: ints and bytes as is, bools as 0/1.
+    bool folded = false;
+    int value = 0;
+    int node = -1; // In current_body, while body_ir_enabled.
+    ExpShape shape;
     // NUM, NUM B, STRING, TRUE, FALSE
-    Exp(BaseType* term, const string& rhs);
+    Exp(BaseType* term, TypeId rhs);
     // ID
     Exp(BaseType* term);
     // Call
@@ -168,11 +398,18 @@ public:
     // NOT
     Exp(bool not_mark, Exp* exp);
     // Exp RELOP/BINOP Exp
-    Exp(Exp* first, const OP_TYPE& op, Exp* second);
+    Exp(Exp* first, const OP_TYPE& op, Exp* second, BaseType* op_token);
     // LPAREN Exp RPAREN
     Exp(Exp* exp);
     // LPAREN Type RPAREN Exp
     Exp(Type* new_type, Exp* exp);
+    /* Returns the expression of the same shape seen earlier in an open scope, deleting exp, or
+       keeps exp as that expression. The parser passes every new Exp through this, so identical
+       side-effect-free expressions are stored once and later passes see them shared. */
+    static Exp* share(Exp* exp);
+private:
+    // Computes value from the operands of Exp RELOP/BINOP Exp once type is known.
+    void fold(Exp* first, const OP_TYPE& op, Exp* second, const string& op_text);
 };
 
 class ExpList : public BaseType {
@@ -191,27 +428,35 @@ public:
 
 class Call : public BaseType {
 public:
-    string ret_type_of_called_func;
+    TypeId ret_type_of_called_func;
+    int node = -1;
+    // Set by --eval-calls when the callee was run on constant arguments.
+    bool folded = false;
+    int value = 0;
     // ID LPAREN ExpList RPAREN
     Call(BaseType* id, ExpList* list);
     // ID LPAREN RPAREN
     explicit Call(BaseType* id);
+private:
+    void fold_call(const FuncSignature* func, const vector<Exp*>& args);
 };
 
 class Statement; 
 
 class Statements : public BaseType {
 public:
+    vector<int> items; // Nodes of the statements, while body_ir_enabled.
     // Statement
-    explicit Statements(Statement* rhs_statement) {}
+    explicit Statements(Statement* rhs_statement);
     // Statements Statement
-    Statements(Statements* rhs_statements, Statement* rhs_statement) {}
+    Statements(Statements* rhs_statements, Statement* rhs_statement);
 };
 
 class Statement : public BaseType {
 public:
+    int node = -1;
     // LBRACE Statements RBRACE
-    explicit Statement(Statements* rhs_statements) {}
+    explicit Statement(Statements* rhs_statements);
     // TypeAnnotation Type ID SC
     Statement(Type* type, BaseType* id, TypeAnnotation* const_anno);
     // TypeAnnotation Type ID Assign Exp SC
@@ -219,17 +464,18 @@ public:
     // ID Assign Exp SC
     Statement(BaseType* id, Exp* exp);
     // Call SC
-    explicit Statement(Call* call) {}
+    explicit Statement(Call* call);
     // Return SC (void)
     explicit Statement();
     // Return Exp SC (not void)
     explicit Statement(Exp* exp);
     // IF etc...
-    Statement(const string& type, Exp* exp);
+    Statement(const string& type, Exp* exp, Statement* body, Statement* else_part = nullptr);
     // BREAK, CONTINUE
     explicit Statement(const Break_Cont& type);
 };
 
-void checkBoolExp(Exp* exp);
+/* Returns exp, or a copy typed ERROR after reporting that it is not boolean; a shared exp is not changed. */
+Exp* checkBoolExp(Exp* exp);
 
 #endif //COMPIHW3_SEMANTICANALYZER_H
@@ -0,0 +1,256 @@
+#include "SymbolDb.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using std::string;
+using std::vector;
+
+SymbolDbBuilder* symbol_db = nullptr;
+
+/* ************************************************ */
+DbString SymbolDbBuilder::intern(const string& text) {
+    auto it = string_offsets.find(text);
+    if (it == string_offsets.end()) {
+        it = string_offsets.emplace(text, (uint32_t)strings.size()).first;
+        strings += text;
+        strings += '\0';
+    }
+    return { it->second, (uint32_t)text.size() };
+}
+
+/* ************************************************ */
+void SymbolDbBuilder::add_scope(int function, int depth) {
+    DbScope scope;
+    scope.function = function;
+    scope.depth = (uint32_t)depth;
+    scope.symbols = { (uint32_t)symbols.size(), 0 };
+    scopes.push_back(scope);
+}
+
+/* ************************************************ */
+void SymbolDbBuilder::add_symbol(const string& name, int type, int offset, bool is_const) {
+    DbSymbol symbol = {};
+    symbol.name = intern(name);
+    symbol.offset = offset;
+    symbol.scope = (uint32_t)scopes.size() - 1;
+    symbol.type = (uint8_t)type;
+    symbol.is_const = is_const;
+    symbols.push_back(symbol);
+    scopes.back().symbols.count++;
+}
+
+/* ************************************************ */
+void SymbolDbBuilder::add_function(const string& name, const string& signature, int ret_type,
+                                   const vector<int>& param_types, const vector<bool>& const_params,
+                                   const vector<int>& function_callees) {
+    DbFunction function = {};
+    function.name = intern(name);
+    function.signature = intern(signature);
+    function.ret_type = (uint8_t)ret_type;
+    function.params = { (uint32_t)params.size(), (uint32_t)param_types.size() };
+    for (size_t i = 0; i < param_types.size(); i++) {
+        DbParam param = {};
+        param.type = (uint8_t)param_types[i];
+        param.is_const = const_params[i];
+        params.push_back(param);
+    }
+    functions.push_back(function);
+    callees.push_back(function_callees);
+}
+
+/* Indices 0..count-1 sorted by the name of each, ties in index order. */
+template <typename Record>
+static vector<uint32_t> sorted_by_name(const vector<Record>& records, const string& strings) {
+    vector<uint32_t> order(records.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = (uint32_t)i;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return strcmp(&strings[records[a].name.offset], &strings[records[b].name.offset]) < 0;
+    });
+    return order;
+}
+
+/* ************************************************ */
+bool SymbolDbBuilder::write(const string& path) {
+    // Callers, grouped by callee in function order.
+    vector<vector<uint32_t>> callers(functions.size());
+    vector<uint32_t> flat_callees;
+    for (size_t f = 0; f < functions.size(); f++) {
+        functions[f].callees = { (uint32_t)flat_callees.size(), (uint32_t)callees[f].size() };
+        for (int callee : callees[f]) {
+            flat_callees.push_back((uint32_t)callee);
+            callers[callee].push_back((uint32_t)f);
+        }
+    }
+    vector<uint32_t> flat_callers;
+    for (size_t f = 0; f < functions.size(); f++) {
+        functions[f].callers = { (uint32_t)flat_callers.size(), (uint32_t)callers[f].size() };
+        flat_callers.insert(flat_callers.end(), callers[f].begin(), callers[f].end());
+    }
+    vector<uint32_t> functions_by_name = sorted_by_name(functions, strings);
+    vector<uint32_t> symbols_by_name = sorted_by_name(symbols, strings);
+
+    DbHeader header = {};
+    memcpy(header.magic, symbol_db_magic, sizeof(header.magic));
+    header.version = symbol_db_version;
+    uint32_t end = sizeof(DbHeader);
+    auto place = [&](DbRange& range, size_t count, size_t record_size) {
+        range = { end, (uint32_t)count };
+        end += (uint32_t)(count * record_size);
+    };
+    place(header.functions, functions.size(), sizeof(DbFunction));
+    place(header.params, params.size(), sizeof(DbParam));
+    place(header.scopes, scopes.size(), sizeof(DbScope));
+    place(header.symbols, symbols.size(), sizeof(DbSymbol));
+    place(header.callees, flat_callees.size(), sizeof(uint32_t));
+    place(header.callers, flat_callers.size(), sizeof(uint32_t));
+    place(header.functions_by_name, functions_by_name.size(), sizeof(uint32_t));
+    place(header.symbols_by_name, symbols_by_name.size(), sizeof(uint32_t));
+    place(header.strings, strings.size(), 1);
+    header.file_size = end;
+
+    // Write aside and rename, so a reader that has the old file mapped never sees it change under it.
+    string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        auto write_all = [&](const void* data, size_t size) {
+            out.write(static_cast<const char*>(data), size);
+        };
+        write_all(&header, sizeof(header));
+        write_all(functions.data(), functions.size() * sizeof(DbFunction));
+        write_all(params.data(), params.size() * sizeof(DbParam));
+        write_all(scopes.data(), scopes.size() * sizeof(DbScope));
+        write_all(symbols.data(), symbols.size() * sizeof(DbSymbol));
+        write_all(flat_callees.data(), flat_callees.size() * sizeof(uint32_t));
+        write_all(flat_callers.data(), flat_callers.size() * sizeof(uint32_t));
+        write_all(functions_by_name.data(), functions_by_name.size() * sizeof(uint32_t));
+        write_all(symbols_by_name.data(), symbols_by_name.size() * sizeof(uint32_t));
+        write_all(strings.data(), strings.size());
+        if (!out.flush())
+            return false;
+    }
+    return rename(temp_path.c_str(), path.c_str()) == 0;
+}
+
+/* ************************************************ */
+SymbolDb::~SymbolDb() {
+    if (base)
+        munmap(const_cast<char*>(base), size);
+}
+
+/* ************************************************ */
+bool SymbolDb::open(const string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    void* memory = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(DbHeader))
+        memory = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+        return false;
+    base = static_cast<const char*>(memory);
+    size = (size_t)info.st_size;
+    header = reinterpret_cast<const DbHeader*>(base);
+    auto fits = [&](DbRange range, size_t record_size) {
+        return range.first % 4 == 0 && range.first <= size && range.count <= (size - range.first) / record_size;
+    };
+    bool valid = memcmp(header->magic, symbol_db_magic, sizeof(header->magic)) == 0 &&
+                 header->version == symbol_db_version && header->file_size == size &&
+                 fits(header->functions, sizeof(DbFunction)) && fits(header->params, sizeof(DbParam)) &&
+                 fits(header->scopes, sizeof(DbScope)) && fits(header->symbols, sizeof(DbSymbol)) &&
+                 fits(header->callees, sizeof(uint32_t)) && fits(header->callers, sizeof(uint32_t)) &&
+                 fits(header->functions_by_name, sizeof(uint32_t)) && fits(header->symbols_by_name, sizeof(uint32_t)) &&
+                 header->strings.first <= size && header->strings.count <= size - header->strings.first &&
+                 records_valid();
+    if (!valid) {
+        munmap(memory, size);
+        base = nullptr;
+        header = nullptr;
+    }
+    return valid;
+}
+
+/* ************************************************ */
+static bool within(DbRange range, uint32_t count) {
+    return range.first <= count && range.count <= count - range.first;
+}
+
+/* ************************************************ */
+static bool all_below(const uint32_t* indices, uint32_t count, uint32_t limit) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (indices[i] >= limit)
+            return false;
+    }
+    return true;
+}
+
+/* ************************************************ */
+bool SymbolDb::valid_string(DbString s) const {
+    uint32_t count = header->strings.count;
+    return s.offset < count && s.size < count - s.offset && text(s)[s.size] == '\0';
+}
+
+/* Checks every index and string offset in the records against the sections they point into, once the
+   sections are known to fit in the file. */
+bool SymbolDb::records_valid() const {
+    const uint8_t num_types = sizeof(db_type_names) / sizeof(db_type_names[0]);
+    uint32_t num_params = header->params.count;
+    for (uint32_t f = 0; f < num_functions(); f++) {
+        const DbFunction& record = function(f);
+        if (!valid_string(record.name) || !valid_string(record.signature) || record.ret_type >= num_types ||
+            !within(record.params, num_params) || !within(record.callees, header->callees.count) ||
+            !within(record.callers, header->callers.count))
+            return false;
+    }
+    const DbParam* all_params = section<DbParam>(header->params);
+    for (uint32_t p = 0; p < num_params; p++) {
+        if (all_params[p].type >= num_types)
+            return false;
+    }
+    for (uint32_t s = 0; s < num_scopes(); s++) {
+        const DbScope& record = scope(s);
+        if (record.function < -1 || record.function >= (int64_t)num_functions() || !within(record.symbols, num_symbols()))
+            return false;
+    }
+    for (uint32_t s = 0; s < num_symbols(); s++) {
+        const DbSymbol& record = symbol(s);
+        if (!valid_string(record.name) || record.scope >= num_scopes() || record.type >= num_types)
+            return false;
+    }
+    return all_below(section<uint32_t>(header->callees), header->callees.count, num_functions()) &&
+           all_below(section<uint32_t>(header->callers), header->callers.count, num_functions()) &&
+           all_below(section<uint32_t>(header->functions_by_name), header->functions_by_name.count, num_functions()) &&
+           all_below(section<uint32_t>(header->symbols_by_name), header->symbols_by_name.count, num_symbols());
+}
+
+/* ************************************************ */
+int SymbolDb::find_function(const char* name) const {
+    const uint32_t* order = section<uint32_t>(header->functions_by_name);
+    const uint32_t* last = order + header->functions_by_name.count;
+    const uint32_t* it = std::lower_bound(order, last, name, [&](uint32_t f, const char* key) {
+        return strcmp(text(function(f).name), key) < 0;
+    });
+    if (it == last || strcmp(text(function(*it).name), name) != 0)
+        return -1;
+    return (int)*it;
+}
+
+/* ************************************************ */
+void SymbolDb::find_symbols(const char* name, const uint32_t** first, const uint32_t** last) const {
+    const uint32_t* order = section<uint32_t>(header->symbols_by_name);
+    const uint32_t* end = order + header->symbols_by_name.count;
+    *first = std::lower_bound(order, end, name, [&](uint32_t s, const char* key) {
+        return strcmp(text(symbol(s).name), key) < 0;
+    });
+    *last = std::upper_bound(*first, end, name, [&](const char* key, uint32_t s) {
+        return strcmp(key, text(symbol(s).name)) < 0;
+    });
+}
@@ -0,0 +1,151 @@
+#ifndef COMPIHW3_SYMBOLDB_H
+#define COMPIHW3_SYMBOLDB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* --symbol-db=FILE: the analysis as a file that is queried in place after mmap, with nothing to parse.
+
+   The file is a header followed by arrays of fixed-size records, in native byte order. Records refer
+   to each other by index and to strings by offset into the string area, so the file can be mapped at
+   any address. Strings are interned and end with a NUL.
+
+   Types are codes in the order of db_type_names, which is that of TypeId. Scopes come in the order
+   they were closed, innermost first, as in the scope dumps; function -1 is the global scope. Each
+   function's callees and callers are ranges of function indices, and functions_by_name and
+   symbols_by_name hold record indices sorted by name, for binary search. */
+
+constexpr const char* db_type_names[] = { "VOID", "BOOL", "INT", "BYTE", "STRING", "ERROR" };
+constexpr char symbol_db_magic[8] = { 'F', 'N', 'C', 'S', 'Y', 'M', 'D', 'B' };
+constexpr uint32_t symbol_db_version = 1;
+
+class DbString {
+public:
+    uint32_t offset;
+    uint32_t size; // Without the NUL.
+};
+
+class DbRange {
+public:
+    uint32_t first;
+    uint32_t count;
+};
+
+class DbFunction {
+public:
+    DbString name;
+    DbString signature; // "(INT,BYTE)->VOID", as in the scope dumps.
+    DbRange params;
+    DbRange callees;    // In the callees section, in order of first call.
+    DbRange callers;    // In the callers section, in function order.
+    uint8_t ret_type;
+    uint8_t padding[3];
+};
+
+class DbParam {
+public:
+    uint8_t type;
+    uint8_t is_const;
+    uint8_t padding[2];
+};
+
+class DbScope {
+public:
+    int32_t function;
+    uint32_t depth;     // 0 for the global scope, 1 for a function's parameters and outer block.
+    DbRange symbols;
+};
+
+class DbSymbol {
+public:
+    DbString name;
+    int32_t offset;
+    uint32_t scope;
+    uint8_t type;
+    uint8_t is_const;
+    uint8_t padding[2];
+};
+
+class DbHeader {
+public:
+    char magic[8];
+    uint32_t version;
+    uint32_t file_size;
+    DbRange functions;         // Each section is first: byte offset, count: number of records.
+    DbRange params;
+    DbRange scopes;
+    DbRange symbols;
+    DbRange callees;           // uint32_t function indices.
+    DbRange callers;
+    DbRange functions_by_name; // uint32_t function indices.
+    DbRange symbols_by_name;   // uint32_t symbol indices.
+    DbRange strings;           // Bytes.
+};
+
+/* Collects the records while the analysis runs and writes the file at the end. */
+class SymbolDbBuilder {
+public:
+    // The symbols added next belong to this scope.
+    void add_scope(int function, int depth);
+    void add_symbol(const std::string& name, int type, int offset, bool is_const);
+    // Functions are added in id order, after every scope.
+    void add_function(const std::string& name, const std::string& signature, int ret_type,
+                      const std::vector<int>& param_types, const std::vector<bool>& const_params,
+                      const std::vector<int>& callees);
+    bool write(const std::string& path);
+
+private:
+    std::vector<DbFunction> functions;
+    std::vector<DbParam> params;
+    std::vector<DbScope> scopes;
+    std::vector<DbSymbol> symbols;
+    std::vector<std::vector<int>> callees;
+    std::string strings;
+    std::unordered_map<std::string, uint32_t> string_offsets;
+    DbString intern(const std::string& text);
+};
+
+/* Null unless --symbol-db is given. */
+extern SymbolDbBuilder* symbol_db;
+
+/* A mapped symbol database. Lookups by name are binary searches over the sorted indices. */
+class SymbolDb {
+public:
+    SymbolDb() = default;
+    SymbolDb(const SymbolDb&) = delete;
+    SymbolDb& operator=(const SymbolDb&) = delete;
+    ~SymbolDb();
+    // False if the file is missing, is not a symbol database, or is truncated or inconsistent. Every
+    // index, range and string offset in it is checked, so lookups never leave the mapping.
+    bool open(const std::string& path);
+
+    uint32_t num_functions() const { return header->functions.count; }
+    uint32_t num_scopes() const { return header->scopes.count; }
+    uint32_t num_symbols() const { return header->symbols.count; }
+    const DbFunction& function(uint32_t i) const { return section<DbFunction>(header->functions)[i]; }
+    const DbScope& scope(uint32_t i) const { return section<DbScope>(header->scopes)[i]; }
+    const DbSymbol& symbol(uint32_t i) const { return section<DbSymbol>(header->symbols)[i]; }
+    const DbParam* params(const DbFunction& f) const { return section<DbParam>(header->params) + f.params.first; }
+    const uint32_t* callees(const DbFunction& f) const { return section<uint32_t>(header->callees) + f.callees.first; }
+    const uint32_t* callers(const DbFunction& f) const { return section<uint32_t>(header->callers) + f.callers.first; }
+    const char* text(DbString s) const { return base + header->strings.first + s.offset; }
+
+    // Index of the function called name, or -1.
+    int find_function(const char* name) const;
+    // Indices of the symbols called name, in [*first, *last).
+    void find_symbols(const char* name, const uint32_t** first, const uint32_t** last) const;
+
+private:
+    const char* base = nullptr;
+    size_t size = 0;
+    const DbHeader* header = nullptr;
+    bool valid_string(DbString s) const;
+    bool records_valid() const;
+    template <typename T>
+    const T* section(DbRange range) const { return reinterpret_cast<const T*>(base + range.first); }
+};
+
+#endif //COMPIHW3_SYMBOLDB_H
@@ -0,0 +1,62 @@
+#include "TokenStream.h"
+#include "parser.tab.hpp"
+
+using namespace output;
+
+static bool recording = false;
+static const Token* replay_pos = nullptr;
+static const Token* replay_end = nullptr;
+static int replay_eof_lineno;
+
+/* ************************************************ */
+int lexical_error() {
+    if (recording)
+        return LEX_ERROR;
+    errorLex(yylineno);
+    fatal_error(yylineno);
+}
+
+/* ************************************************ */
+void TokenStream::lex_all() {
+    recording = true;
+    while (true) {
+        int kind = yylex();
+        if (kind == 0)
+            break;
+        tokens.push_back({ kind, yylineno, yylval });
+        if (kind == LEX_ERROR)
+            break;
+    }
+    eof_lineno = yylineno;
+    recording = false;
+}
+
+/* ************************************************ */
+void replay_tokens(const Token* begin, const Token* end, int eof_lineno) {
+    replay_pos = begin;
+    replay_end = end;
+    replay_eof_lineno = eof_lineno;
+}
+
+/* ************************************************ */
+void stop_replay() {
+    replay_pos = replay_end = nullptr;
+}
+
+/* ************************************************ */
+int next_token() {
+    if (!replay_pos)
+        return yylex();
+    if (replay_pos == replay_end) {
+        yylineno = replay_eof_lineno;
+        return 0;
+    }
+    const Token& token = *replay_pos++;
+    yylineno = token.lineno;
+    if (token.kind == LEX_ERROR) {
+        errorLex(yylineno);
+        fatal_error(yylineno);
+    }
+    yylval = token.value;
+    return token.kind;
+}
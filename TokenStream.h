@@ -0,0 +1,34 @@
+#ifndef COMPIHW3_TOKENSTREAM_H
+#define COMPIHW3_TOKENSTREAM_H
+
+#include "SemanticAnalyzer.h"
+
+/* Kind of the token standing for a lexical error; never reaches the parser. */
+constexpr int LEX_ERROR = -1;
+
+class Token {
+public:
+    int kind;
+    int lineno; // yylineno right after the scanner returned the token.
+    BaseType* value;
+};
+
+/* Tokens of a whole input, lexed up front. A lexical error ends the stream with a LEX_ERROR
+   token, so the error is reported only when the parser reaches it. */
+class TokenStream {
+public:
+    vector<Token> tokens;
+    int eof_lineno = 1;
+    // Reads yyin to the end.
+    void lex_all();
+};
+
+/* The parser reads tokens through this (see parser.ypp): straight from the scanner, or from a
+   range of recorded tokens while replaying. */
+int next_token();
+
+/* Feeds [begin, end) to the parser, then end of input with yylineno set to eof_lineno. */
+void replay_tokens(const Token* begin, const Token* end, int eof_lineno);
+void stop_replay();
+
+#endif //COMPIHW3_TOKENSTREAM_H
@@ -0,0 +1,164 @@
+#include "WorkerPool.h"
+#include <atomic>
+#include <cerrno>
+#include <iostream>
+#include <new>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using std::string;
+using std::vector;
+
+/* Shared between the parent and all workers. */
+struct SharedState {
+    std::atomic<int> next_job;
+    std::atomic<int> first_failed;
+};
+
+/* Header of one result sent back over a worker's pipe. */
+struct ResultHeader {
+    int job;
+    int failed;
+    int status;
+    size_t size;
+};
+
+/* ************************************************ */
+static bool write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+/* ************************************************ */
+static void run_worker(SharedState* shared, int num_jobs, int fd, const std::function<JobResult(int)>& job) {
+    while (true) {
+        int j = shared->next_job.fetch_add(1);
+        if (j >= num_jobs || j > shared->first_failed.load())
+            break;
+        JobResult result = job(j);
+        if (result.failed) {
+            int current = shared->first_failed.load();
+            while (j < current && !shared->first_failed.compare_exchange_weak(current, j)) {}
+        }
+        ResultHeader header = { j, result.failed, result.status, result.output.size() };
+        if (!write_all(fd, reinterpret_cast<const char*>(&header), sizeof(header)) ||
+            !write_all(fd, result.output.data(), result.output.size()))
+            break;
+    }
+}
+
+/* ************************************************ */
+int default_num_workers() {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+/* ************************************************ */
+vector<JobResult> run_jobs(int num_jobs, int num_workers, const std::function<JobResult(int)>& job) {
+    vector<JobResult> results(num_jobs);
+    if (num_workers > num_jobs)
+        num_workers = num_jobs;
+    if (num_workers <= 1) {
+        for (int j = 0; j < num_jobs; j++) {
+            results[j] = job(j);
+            if (results[j].failed)
+                break;
+        }
+        return results;
+    }
+
+    void* memory = mmap(nullptr, sizeof(SharedState), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    SharedState* shared = new (memory) SharedState();
+    shared->next_job = 0;
+    shared->first_failed = num_jobs;
+
+    // Anything still buffered would otherwise be written once more by every worker.
+    std::cout.flush();
+    vector<pid_t> pids;
+    vector<pollfd> fds;
+    for (int w = 0; w < num_workers; w++) {
+        int pipe_fds[2];
+        if (pipe(pipe_fds) != 0)
+            break;
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(pipe_fds[0]);
+            for (const auto& other : fds)
+                close(other.fd);
+            run_worker(shared, num_jobs, pipe_fds[1], job);
+            close(pipe_fds[1]);
+            _exit(0);
+        }
+        close(pipe_fds[1]);
+        if (pid < 0) {
+            close(pipe_fds[0]);
+            break;
+        }
+        pids.push_back(pid);
+        fds.push_back({ pipe_fds[0], POLLIN, 0 });
+    }
+
+    // Collect results as workers send them. Each pipe carries a sequence of header + output frames.
+    vector<string> pending(fds.size());
+    int open_pipes = (int)fds.size();
+    char buffer[1 << 16];
+    while (open_pipes > 0) {
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        for (size_t w = 0; w < fds.size(); w++) {
+            if (fds[w].fd < 0 || !(fds[w].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+            ssize_t got = read(fds[w].fd, buffer, sizeof(buffer));
+            if (got < 0 && errno == EINTR)
+                continue;
+            if (got <= 0) {
+                close(fds[w].fd);
+                fds[w].fd = -1;
+                open_pipes--;
+                continue;
+            }
+            string& data = pending[w];
+            data.append(buffer, got);
+            size_t pos = 0;
+            while (data.size() - pos >= sizeof(ResultHeader)) {
+                ResultHeader header;
+                data.copy(reinterpret_cast<char*>(&header), sizeof(header), pos);
+                if (data.size() - pos - sizeof(header) < header.size)
+                    break;
+                JobResult& result = results[header.job];
+                result.done = true;
+                result.failed = header.failed;
+                result.status = header.status;
+                result.output = data.substr(pos + sizeof(header), header.size);
+                pos += sizeof(header) + header.size;
+            }
+            data.erase(0, pos);
+        }
+    }
+    for (pid_t pid : pids)
+        waitpid(pid, nullptr, 0);
+    munmap(memory, sizeof(SharedState));
+
+    // A worker that died unexpectedly leaves holes; fill the ones that still matter here.
+    for (int j = 0; j < num_jobs; j++) {
+        if (!results[j].done)
+            results[j] = job(j);
+        if (results[j].failed)
+            break;
+    }
+    return results;
+}
@@ -0,0 +1,27 @@
+#ifndef COMPIHW3_WORKERPOOL_H
+#define COMPIHW3_WORKERPOOL_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/* What one job produced. */
+class JobResult {
+public:
+    bool done = false;   // False if the job never ran, e.g. because an earlier job failed.
+    bool failed = false; // The job stopped at an error.
+    int status = 0;      // Passed back as is; batch mode keeps the input's exit status here.
+    std::string output;
+};
+
+/* Runs jobs 0..num_jobs-1 on num_workers forked processes and returns their results by job index.
+   The scanner, the parser and the analyzer keep their state in globals, so every worker is a process
+   with its own copy of that state rather than a thread. An idle worker takes the next unclaimed job
+   from a counter in shared memory, so one slow job never holds the others back. Once a job fails,
+   workers stop taking jobs after it. With one worker, or one job, everything runs in this process. */
+std::vector<JobResult> run_jobs(int num_jobs, int num_workers, const std::function<JobResult(int)>& job);
+
+/* One worker per online CPU. */
+int default_num_workers();
+
+#endif //COMPIHW3_WORKERPOOL_H
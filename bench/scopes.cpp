@@ -0,0 +1,114 @@
+// Scope push/pop throughput and symbol storage cost of the semantic analyzer.
+// build: make bench/scopes    run: bench/scopes [scopes] [vars per scope]
+#include "../SemanticAnalyzer.h"
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+int yylineno = 1;
+extern vector<SymbolEntry> symbol_stack;
+
+static long live_bytes = 0;
+static long peak_bytes = 0;
+static long allocations = 0;
+
+void* operator new(size_t size) {
+    size_t* p = static_cast<size_t*>(malloc(size + sizeof(size_t)));
+    if (!p)
+        throw std::bad_alloc();
+    *p = size;
+    allocations++;
+    live_bytes += size;
+    if (live_bytes > peak_bytes)
+        peak_bytes = live_bytes;
+    return p + 1;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr)
+        return;
+    size_t* p = static_cast<size_t*>(ptr) - 1;
+    live_bytes -= *p;
+    free(p);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+class NullBuf : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+int main(int argc, char* argv[]) {
+    const int num_scopes = argc > 1 ? atoi(argv[1]) : 200000;
+    const int vars_per_scope = argc > 2 ? atoi(argv[2]) : 4;
+    NullBuf null_buf;
+    std::streambuf* stdout_buf = std::cout.rdbuf(&null_buf);
+
+    BaseType int_token("int");
+    Type int_type(&int_token, TypeId::INT);
+    TypeAnnotation no_const;
+    vector<BaseType> ids;
+    for (int i = 0; i < vars_per_scope; i++)
+        ids.emplace_back("variableNumber" + std::to_string(i));
+
+    create_global_scope();
+
+    // Storage cost: declare many symbols in one scope. The second round reuses names seen in the first,
+    // as locals of different functions do, so it pays for the symbols but not for their names.
+    const int num_syms = 100000;
+    vector<BaseType> many_ids;
+    for (int i = 0; i < num_syms; i++)
+        many_ids.emplace_back("sym" + std::to_string(i));
+    long symbol_bytes[2];
+    for (int round = 0; round < 2; round++) {
+        create_new_scope();
+        long before = live_bytes;
+        peak_bytes = live_bytes;
+        for (int i = 0; i < num_syms; i++)
+            Statement(&int_type, &many_ids[i], &no_const);
+        symbol_bytes[round] = peak_bytes - before;
+        destroy_current_scope();
+        // Each round grows the symbol stack from nothing, rather than into what the last one left.
+        symbol_stack.shrink_to_fit();
+    }
+
+    // Throughput: open a scope, declare a few locals, close it.
+    long allocations_before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int s = 0; s < num_scopes; s++) {
+        create_new_scope();
+        for (int i = 0; i < vars_per_scope; i++)
+            Statement(&int_type, &ids[i], &no_const);
+        destroy_current_scope();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    double allocations_per_scope = (double)(allocations - allocations_before) / num_scopes;
+
+    // Deep nesting: open 1000 empty scopes, then close them all.
+    const int depth = 1000;
+    const int rounds = num_scopes / depth + 1;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (int d = 0; d < depth; d++)
+            create_new_scope();
+        for (int d = 0; d < depth; d++)
+            destroy_current_scope();
+    }
+    end = std::chrono::steady_clock::now();
+    double nested_ns = std::chrono::duration<double, std::nano>(end - start).count();
+    std::cout.rdbuf(stdout_buf);
+
+    std::cerr << "sizeof(SymbolEntry): " << sizeof(SymbolEntry) << std::endl;
+    std::cerr << "peak bytes per symbol, new names: " << (double)symbol_bytes[0] / num_syms << std::endl;
+    std::cerr << "peak bytes per symbol, known names: " << (double)symbol_bytes[1] / num_syms << std::endl;
+    std::cerr << "scope push/pop with " << vars_per_scope << " vars: " << ns / num_scopes << " ns ("
+              << num_scopes / (ns / 1e9) << " scopes/s)" << std::endl;
+    std::cerr << "heap allocations per scope: " << allocations_per_scope << std::endl;
+    std::cerr << "empty scope push/pop at depth " << depth << ": " << nested_ns / ((double)rounds * depth) << " ns" << std::endl;
+    return 0;
+}
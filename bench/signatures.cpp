@@ -0,0 +1,93 @@
+// Cost of formatting function signatures: the old stringstream path against direct appends and the
+// signature table.
+// build: make bench/signatures    run: bench/signatures [signatures]
+#include "../SemanticAnalyzer.h"
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+int yylineno = 1;
+
+static long allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+// makeFunctionType and typeListToString as they were, with a stringstream per list.
+static string stream_type_list(const vector<string>& arg_types) {
+    std::stringstream res;
+    res << "(";
+    for (size_t i = 0; i < arg_types.size(); ++i) {
+        res << arg_types[i];
+        if (i + 1 < arg_types.size())
+            res << ",";
+    }
+    res << ")";
+    return res.str();
+}
+
+static string stream_function_type(const string& ret_type, const vector<string>& arg_types) {
+    std::stringstream res;
+    res << stream_type_list(arg_types) << "->" << ret_type;
+    return res.str();
+}
+
+static long checksum = 0; // Keeps the results alive.
+
+template <typename F>
+static void measure(const char* name, int count, F format) {
+    long allocations_before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+        format(i);
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    std::cerr << name << ": " << ns / count << " ns, "
+              << (double)(allocations - allocations_before) / count << " allocations per signature" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const int count = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    // A handful of distinct signatures, as in real programs, declared over and over.
+    const TypeId types[] = { TypeId::INT, TypeId::BYTE, TypeId::BOOL, TypeId::STRING };
+    vector<vector<TypeId>> params(16);
+    vector<vector<string>> param_names(16);
+    for (int s = 0; s < 16; s++) {
+        for (int k = 0; k < s % 5; k++) {
+            params[s].push_back(types[(s + k) % 4]);
+            param_names[s].push_back(type_name(params[s].back()));
+        }
+    }
+
+    measure("stringstream", count, [&](int i) {
+        string args = stream_type_list(param_names[i % 16]);
+        string type = stream_function_type("VOID", param_names[i % 16]);
+        checksum += args.size() + type.size();
+    });
+    measure("appends", count, [&](int i) {
+        string args = output::typeListToString(param_names[i % 16]);
+        string type = output::makeFunctionType("VOID", param_names[i % 16]);
+        checksum += args.size() + type.size();
+    });
+    measure("signature table", count, [&](int i) {
+        const string* args = intern_args_string(params[i % 16]);
+        const string* type = intern_type_string(TypeId::VOID, params[i % 16]);
+        checksum += args->size() + type->size();
+    });
+    return checksum == 0;
+}
@@ -0,0 +1,39 @@
+// Wall time and write(2) calls of a command, as counted by the kernel for the process.
+// build: make bench/syscalls    run: bench/syscalls ./hw3 [options] < program
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/wait.h>
+#include <unistd.h>
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s command [args] < input\n", argv[0]);
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        execv(argv[1], argv + 1);
+        _exit(127);
+    }
+    // Wait without reaping, so the counters in /proc are still there.
+    siginfo_t info;
+    waitid(P_PID, pid, &info, WEXITED | WNOWAIT);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/io", (int)pid);
+    long writes = -1;
+    if (FILE* io = fopen(path, "r")) {
+        char line[128];
+        while (fgets(line, sizeof(line), io)) {
+            if (strncmp(line, "syscw:", 6) == 0)
+                writes = atol(line + 6);
+        }
+        fclose(io);
+    }
+    waitpid(pid, nullptr, 0);
+    fprintf(stderr, "%.3f s, %ld write calls\n", seconds, writes);
+    return 0;
+}
@@ -1,27 +1,191 @@
 #include <iostream>
 #include "hw3_output.hpp"
 #include <sstream>
+#include <cstdint>
+#include <cstring>
 
 using namespace std;
+using output::OutputFormat;
+
+// Kind byte of each --format=bin record; see hw3_output.hpp.
+enum class RecordKind : unsigned char {
+    SCOPE_END = 1, SYMBOL, FRAME, LIVE_SLOTS, ERROR, WARNING, NOT_SHOWN, FILE_HEADER
+};
+
+static ostream* error_out = &cout;
+static OutputFormat format = OutputFormat::TEXT;
+
+void output::setErrorStream(ostream& stream) {
+    error_out = &stream;
+}
+
+void output::setFormat(OutputFormat new_format) {
+    format = new_format;
+}
 
 void output::endScope(){
-    cout << "---end scope---" << endl;
+    cout << "---end scope---" << '\n';
 }
 
 void output::printID(const string& id, int offset, const string& type) {
-    cout << id << " " << type <<  " " << offset <<  endl;
+    cout << id << " " << type <<  " " << offset << '\n';
 }
 
-string typeListToString(const std::vector<string>& argTypes) {
-    stringstream res;
-    res << "(";
-    for(int i = 0; i < argTypes.size(); ++i) {
-        res << argTypes[i];
-        if (i + 1 < argTypes.size())
-            res << ",";
+static void append_int(string& out, int value) {
+    char digits[10];
+    int count = 0;
+    unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    do {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0)
+        out += '-';
+    while (count > 0)
+        out += digits[--count];
+}
+
+/* ************************************************ */
+static void append_u32(string& out, uint32_t value) {
+    for (int i = 0; i < 4; i++)
+        out += (char)(value >> (8 * i));
+}
+
+/* ************************************************ */
+static void append_bin_string(string& out, const char* data, size_t length) {
+    append_u32(out, (uint32_t)length);
+    out.append(data, length);
+}
+
+/* ************************************************ */
+static void append_json_string(string& out, const char* data, size_t length) {
+    static const char hex_digits[] = "0123456789abcdef";
+    out += '"';
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)data[i];
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += (char)c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (c == '\t') {
+            out += "\\t";
+        } else if (c < 0x20) {
+            // Any other control byte; raw, it would make the record invalid or split its line.
+            out += "\\u00";
+            out += hex_digits[c >> 4];
+            out += hex_digits[c & 0xf];
+        } else {
+            out += (char)c;
+        }
     }
-    res << ")";
-    return res.str();
+    out += '"';
+}
+
+void output::appendEndScope(string& out) {
+    switch (format) {
+        case OutputFormat::TEXT: out += "---end scope---\n"; break;
+        case OutputFormat::JSONL: out += "{\"kind\":\"scope_end\"}\n"; break;
+        case OutputFormat::BIN: out += (char)RecordKind::SCOPE_END; break;
+    }
+}
+
+void output::appendID(string& out, const string& id, int offset, const char* type, size_t type_length, bool is_const) {
+    switch (format) {
+        case OutputFormat::TEXT:
+            out += id;
+            out += ' ';
+            out.append(type, type_length);
+            out += ' ';
+            append_int(out, offset);
+            out += '\n';
+            break;
+        case OutputFormat::JSONL:
+            out += "{\"kind\":\"symbol\",\"name\":";
+            append_json_string(out, id.data(), id.size());
+            out += ",\"type\":";
+            append_json_string(out, type, type_length);
+            out += ",\"offset\":";
+            append_int(out, offset);
+            out += is_const ? ",\"const\":true}\n" : ",\"const\":false}\n";
+            break;
+        case OutputFormat::BIN:
+            out += (char)RecordKind::SYMBOL;
+            out += (char)is_const;
+            append_u32(out, (uint32_t)offset);
+            append_bin_string(out, id.data(), id.size());
+            append_bin_string(out, type, type_length);
+            break;
+    }
+}
+
+/* A line, record or binary record that gives a function one number. */
+static void append_function_number(string& out, RecordKind kind, const char* field, const string& function, int number) {
+    switch (format) {
+        case OutputFormat::TEXT:
+            out += function;
+            out += ' ';
+            out += field;
+            out += ' ';
+            append_int(out, number);
+            out += '\n';
+            break;
+        case OutputFormat::JSONL:
+            out += kind == RecordKind::FRAME ? "{\"kind\":\"frame\",\"function\":" : "{\"kind\":\"live_slots\",\"function\":";
+            append_json_string(out, function.data(), function.size());
+            out += kind == RecordKind::FRAME ? ",\"bytes\":" : ",\"slots\":";
+            append_int(out, number);
+            out += "}\n";
+            break;
+        case OutputFormat::BIN:
+            out += (char)kind;
+            append_bin_string(out, function.data(), function.size());
+            append_u32(out, (uint32_t)number);
+            break;
+    }
+}
+
+void output::appendFrameSize(string& out, const string& function, int bytes) {
+    append_function_number(out, RecordKind::FRAME, "frame", function, bytes);
+}
+
+void output::appendLiveSlots(string& out, const string& function, int slots) {
+    append_function_number(out, RecordKind::LIVE_SLOTS, "live slots", function, slots);
+}
+
+void output::appendFileHeader(string& out, const string& path) {
+    switch (format) {
+        case OutputFormat::TEXT:
+            out += "==> ";
+            out += path;
+            out += " <==\n";
+            break;
+        case OutputFormat::JSONL:
+            out += "{\"kind\":\"file\",\"path\":";
+            append_json_string(out, path.data(), path.size());
+            out += "}\n";
+            break;
+        case OutputFormat::BIN:
+            out += (char)RecordKind::FILE_HEADER;
+            append_bin_string(out, path.data(), path.size());
+            break;
+    }
+}
+
+void output::appendTypeList(string& out, const std::vector<string>& argTypes) {
+    out += '(';
+    for (size_t i = 0; i < argTypes.size(); ++i) {
+        if (i > 0)
+            out += ',';
+        out += argTypes[i];
+    }
+    out += ')';
+}
+
+string output::typeListToString(const std::vector<string>& argTypes) {
+    string res;
+    appendTypeList(res, argTypes);
+    return res;
 }
 
 string valueListsToString(const std::vector<string>& values) {
@@ -37,59 +201,134 @@ string valueListsToString(const std::vector<string>& values) {
 }
 
 string output::makeFunctionType(const string& retType, std::vector<string>& argTypes) {
-    stringstream res;
-    res << typeListToString(argTypes) << "->" << retType;
-    return res.str();
+    string res;
+    appendTypeList(res, argTypes);
+    res += "->";
+    res += retType;
+    return res;
+}
+
+static string message; // Composed messages; kept, so reporting does not allocate once it has grown.
+static string record;
+
+/* Writes a diagnostic to the error stream; lineno 0 for one about the whole program. */
+static void emit_diagnostic(RecordKind kind, int lineno, const char* text, size_t length) {
+    record.clear();
+    switch (format) {
+        case OutputFormat::TEXT:
+            if (lineno > 0) {
+                record += "line ";
+                append_int(record, lineno);
+                record += ": ";
+            }
+            record.append(text, length);
+            record += '\n';
+            break;
+        case OutputFormat::JSONL:
+            record += kind == RecordKind::ERROR ? "{\"kind\":\"error\",\"line\":" : "{\"kind\":\"warning\",\"line\":";
+            append_int(record, lineno);
+            record += ",\"message\":";
+            append_json_string(record, text, length);
+            record += "}\n";
+            break;
+        case OutputFormat::BIN:
+            record += (char)kind;
+            append_u32(record, (uint32_t)lineno);
+            append_bin_string(record, text, length);
+            break;
+    }
+    error_out->write(record.data(), record.size());
+}
+
+static void emit_error(int lineno, const char* text) {
+    emit_diagnostic(RecordKind::ERROR, lineno, text, strlen(text));
+}
+
+static void emit_error(int lineno, const string& text) {
+    emit_diagnostic(RecordKind::ERROR, lineno, text.data(), text.size());
 }
 
 void output::errorLex(int lineno){
-    cout << "line " << lineno << ":" << " lexical error" << endl;
+    emit_error(lineno, "lexical error");
 }
 
 void output::errorSyn(int lineno){
-    cout << "line " << lineno << ":" << " syntax error" << endl;
+    emit_error(lineno, "syntax error");
 }
 
 void output::errorUndef(int lineno, const string& id){
-    cout << "line " << lineno << ":" << " variable " << id << " is not defined" << endl;
+    emit_error(lineno, message.assign("variable ").append(id).append(" is not defined"));
 }
 
 void output::errorDef(int lineno, const string& id){
-    cout << "line " << lineno << ":" << " identifier " << id << " is already defined" << endl;
+    emit_error(lineno, message.assign("identifier ").append(id).append(" is already defined"));
 }
 
 void output::errorUndefFunc(int lineno, const string& id) {
-    cout << "line " << lineno << ":" << " function " << id << " is not defined" << endl;
+    emit_error(lineno, message.assign("function ").append(id).append(" is not defined"));
 }
 
 void output::errorMismatch(int lineno){
-    cout << "line " << lineno << ":" << " type mismatch" << endl;
+    emit_error(lineno, "type mismatch");
 }
 
 void output::errorPrototypeMismatch(int lineno, const string& id, std::vector<string>& argTypes) {
-    cout << "line " << lineno << ": prototype mismatch, function " << id << " expects arguments " << typeListToString(argTypes) << endl;
+    errorPrototypeMismatch(lineno, id, typeListToString(argTypes));
+}
+
+void output::errorPrototypeMismatch(int lineno, const string& id, const string& argTypes) {
+    emit_error(lineno, message.assign("prototype mismatch, function ").append(id).append(" expects arguments ").append(argTypes));
 }
 
 void output::errorUnexpectedBreak(int lineno) {
-    cout << "line " << lineno << ":" << " unexpected break statement" << endl;
+    emit_error(lineno, "unexpected break statement");
 }
 
 void output::errorUnexpectedContinue(int lineno) {
-    cout << "line " << lineno << ":" << " unexpected continue statement" << endl;	
+    emit_error(lineno, "unexpected continue statement");
 }
 
 void output::errorMainMissing() {
-    cout << "Program has no 'void main()' function" << endl;
+    emit_error(0, "Program has no 'void main()' function");
 }
 
 void output::errorByteTooLarge(int lineno, const string& value) {
-    cout << "line " << lineno << ": byte value " << value << " out of range" << endl;
+    emit_error(lineno, message.assign("byte value ").append(value).append(" out of range"));
 }
 
 void output::errorConstDef(int lineno){
-    cout << "line " << lineno << ":" << " bad const def" << endl;
+    emit_error(lineno, "bad const def");
 }
 
 void output::errorConstMismatch(int lineno){
-    cout << "line " << lineno << ":" << " bad const use" << endl;
-}
\ No newline at end of file
+    emit_error(lineno, "bad const use");
+}
+
+void output::errorDivByZero(int lineno){
+    emit_error(lineno, "division by zero");
+}
+
+void output::warnConstantCondition(int lineno, bool value){
+    const char* text = value ? "condition is always true" : "condition is always false";
+    emit_diagnostic(RecordKind::WARNING, lineno, text, strlen(text));
+}
+
+void output::errorsNotShown(int count){
+    record.clear();
+    switch (format) {
+        case OutputFormat::TEXT:
+            append_int(record, count);
+            record += " more errors not shown\n";
+            break;
+        case OutputFormat::JSONL:
+            record += "{\"kind\":\"not_shown\",\"count\":";
+            append_int(record, count);
+            record += "}\n";
+            break;
+        case OutputFormat::BIN:
+            record += (char)RecordKind::NOT_SHOWN;
+            append_u32(record, (uint32_t)count);
+            break;
+    }
+    cout.write(record.data(), record.size());
+}
@@ -3,19 +3,48 @@
 
 #include <vector>
 #include <string>
+#include <ostream>
 using namespace std;
 extern int yylineno;
 extern int yyleng;
 extern int yylex();
 extern char* yytext;
 namespace output{
+    /* --format: the human-readable lines, one JSON object per line, or binary records. Scope dumps,
+       frame sizes, live slots and diagnostics follow it; the call graph and cost reports are text only.
+
+       A binary stream starts with the four bytes FNC1. Each record is a kind byte and its fields:
+       numbers are 32-bit little-endian, strings a 32-bit length and the bytes.
+         1 scope end
+         2 symbol: const flag (1 byte), offset, name, type
+         3 frame size: function, bytes
+         4 live slots: function, slots
+         5 error, 6 warning: line (0 for the whole program), message
+         7 errors not shown: count
+         8 input file (batch mode): path */
+    enum class OutputFormat { TEXT, JSONL, BIN };
+    void setFormat(OutputFormat format);
+    constexpr const char* binary_magic = "FNC1";
+
     void endScope();
     void printID(const string& id, int offset, const string& type);
 
-    /* Do not save the string returned from this function in a data structure
-        as it is not dynamically allocated and will be destroyed(!) at the end of the calling scope.
-    */
+    /* The lines of endScope and printID, appended to out so a whole scope can be written at once. */
+    void appendEndScope(string& out);
+    void appendID(string& out, const string& id, int offset, const char* type, size_t type_length, bool is_const);
+    void appendFrameSize(string& out, const string& function, int bytes);
+    void appendLiveSlots(string& out, const string& function, int slots);
+    /* Starts the output of one input when a batch writes them all to stdout: "==> path <==". */
+    void appendFileHeader(string& out, const string& path);
+
+    /* "(INT,BYTE)->VOID" and "(INT,BYTE)". Declared functions keep theirs in the signature table
+       of SemanticAnalyzer.h, formatted once; these are for the one-off lists of reports. */
     string makeFunctionType(const string& retType, vector<string>& argTypes);
+    string typeListToString(const std::vector<string>& argTypes);
+    void appendTypeList(string& out, const std::vector<string>& argTypes);
+
+    /* The error functions below write to cout unless another stream is set here. */
+    void setErrorStream(ostream& stream);
 
     void errorLex(int lineno);
     void errorSyn(int lineno);
@@ -24,12 +53,16 @@ namespace output{
     void errorUndefFunc(int lineno, const string& id);
     void errorMismatch(int lineno);
     void errorPrototypeMismatch(int lineno, const string& id, vector<string>& argTypes);
+    void errorPrototypeMismatch(int lineno, const string& id, const string& argTypes);
     void errorUnexpectedBreak(int lineno);
     void errorUnexpectedContinue(int lineno);
     void errorMainMissing();
     void errorByteTooLarge(int lineno, const string& value);
     void errorConstDef(int lineno);
     void errorConstMismatch(int lineno);
+    void errorDivByZero(int lineno);
+    void warnConstantCondition(int lineno, bool value);
+    void errorsNotShown(int count);
 }
 
 #endif
\ No newline at end of file
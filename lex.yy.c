@@ -1040,7 +1040,7 @@ YY_RULE_SETUP
 case 35:
 YY_RULE_SETUP
 #line 49 "scanner.lex"
-{ output::errorLex(yylineno); exit(0); };
+{ return lexical_error(); };
 	YY_BREAK
 case 36:
 YY_RULE_SETUP
@@ -1,4 +1,4 @@
-/* A Bison parser, made by GNU Bison 3.7.6.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
@@ -46,10 +46,10 @@
    USER NAME SPACE" below.  */
 
 /* Identify Bison output, and Bison version.  */
-#define YYBISON 30706
+#define YYBISON 30802
 
 /* Bison version string.  */
-#define YYBISON_VERSION "3.7.6"
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -70,12 +70,17 @@
 #line 1 "parser.ypp"
 
     #include "SemanticAnalyzer.h"
+    #include "TokenStream.h"
+    #include "Driver.h"
+    #include "FunctionBody.h"
     #include "hw3_output.hpp"
     #include <iostream>
     using namespace output;
     void yyerror(char const*);
+    // Tokens may come from the scanner or from a recorded token stream.
+    #define yylex next_token
 
-#line 79 "parser.tab.cpp"
+#line 84 "parser.tab.cpp"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -154,11 +159,13 @@ enum yysymbol_kind_t
   YYSYMBOL_TypeAnnotation = 48,            /* TypeAnnotation  */
   YYSYMBOL_Exp = 49,                       /* Exp  */
   YYSYMBOL_IDWrap = 50,                    /* IDWrap  */
-  YYSYMBOL_M_ENTER_GLOBAL = 51,            /* M_ENTER_GLOBAL  */
-  YYSYMBOL_M_WHILE_ENTER = 52,             /* M_WHILE_ENTER  */
-  YYSYMBOL_M_NEW_SCOPE = 53,               /* M_NEW_SCOPE  */
-  YYSYMBOL_M_DES_SCOPE = 54,               /* M_DES_SCOPE  */
-  YYSYMBOL_M_ENTER_IF = 55                 /* M_ENTER_IF  */
+  YYSYMBOL_ExpWrap = 51,                   /* ExpWrap  */
+  YYSYMBOL_M_ENTER_GLOBAL = 52,            /* M_ENTER_GLOBAL  */
+  YYSYMBOL_M_WHILE_ENTER = 53,             /* M_WHILE_ENTER  */
+  YYSYMBOL_M_LOOP_HEAD = 54,               /* M_LOOP_HEAD  */
+  YYSYMBOL_M_NEW_SCOPE = 55,               /* M_NEW_SCOPE  */
+  YYSYMBOL_M_DES_SCOPE = 56,               /* M_DES_SCOPE  */
+  YYSYMBOL_M_ENTER_IF = 57                 /* M_ENTER_IF  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -316,12 +323,18 @@ typedef int yy_state_fast_t;
 # define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && ! defined __ICC && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                            \
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
     _Pragma ("GCC diagnostic push")                                     \
     _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
 # define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
@@ -480,16 +493,16 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  3
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   218
+#define YYLAST   210
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  34
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  22
+#define YYNNTS  24
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  58
+#define YYNRULES  60
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  108
+#define YYNSTATES  109
 
 /* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   288
@@ -538,15 +551,16 @@ static const yytype_int8 yytranslate[] =
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int8 yyrline[] =
 {
-       0,    43,    43,    44,    45,    47,    46,    50,    51,    52,
-      53,    54,    55,    56,    57,    58,    59,    60,    61,    62,
-      63,    64,    65,    66,    67,    71,    72,    73,    74,    75,
-      76,    77,    78,    79,    80,    81,    82,    83,    84,    85,
-      86,    87,    88,    89,    90,    91,    92,    93,    94,    95,
-      96,    97,    98,    99,   100,   101,   102,   103,   104
+       0,    48,    48,    49,    50,    52,    51,    55,    56,    57,
+      58,    59,    60,    61,    62,    63,    64,    65,    66,    67,
+      68,    69,    70,    71,    72,    76,    77,    78,    79,    80,
+      81,    82,    83,    84,    85,    86,    87,    88,    89,    90,
+      91,    92,    93,    94,    95,    96,    97,    98,    99,   100,
+     101,   102,   103,   104,   105,   106,   107,   108,   109,   110,
+     111
 };
 #endif
 
@@ -569,8 +583,8 @@ static const char *const yytname[] =
   "RBRACE", "LPAREN", "RPAREN", "ELSE", "$accept", "Program", "Funcs",
   "FuncDecl", "@1", "RetType", "Formals", "FormalsList", "FormalDecl",
   "Statements", "Statement", "Call", "ExpList", "Type", "TypeAnnotation",
-  "Exp", "IDWrap", "M_ENTER_GLOBAL", "M_WHILE_ENTER", "M_NEW_SCOPE",
-  "M_DES_SCOPE", "M_ENTER_IF", YY_NULLPTR
+  "Exp", "IDWrap", "ExpWrap", "M_ENTER_GLOBAL", "M_WHILE_ENTER",
+  "M_LOOP_HEAD", "M_NEW_SCOPE", "M_DES_SCOPE", "M_ENTER_IF", YY_NULLPTR
 };
 
 static const char *
@@ -580,19 +594,7 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_int16 yytoknum[] =
-{
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288
-};
-#endif
-
-#define YYPACT_NINF (-36)
+#define YYPACT_NINF (-35)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
@@ -602,130 +604,130 @@ static const yytype_int16 yytoknum[] =
 #define yytable_value_is_error(Yyn) \
   ((Yyn) == YYTABLE_NINF)
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-     -36,     4,   159,   -36,   -36,   -36,   -36,   -36,   -36,   159,
-       1,   -36,   -36,   -36,   -36,   -16,    -3,   -36,    -9,   -36,
-      20,    77,    11,    33,     1,   -36,   -36,   -36,   131,   103,
-      37,    49,    58,    43,   -18,   -36,    79,   -36,    64,    77,
-     -36,   -36,   -36,    52,    80,   -36,   110,     2,   -36,    22,
-     110,   -36,   -36,   110,   110,    57,   131,   -36,   -36,   -36,
-      76,   -36,   -36,    70,   164,   -36,   110,   110,   110,   110,
-     110,   110,   175,   186,   132,   -36,    71,   158,    87,     3,
-     110,   -36,    34,   100,     0,   125,    83,   -36,   -36,   -36,
-     -36,   -36,   110,   -36,   -36,   110,   -36,   131,   131,   -36,
-     146,   -36,    73,   -36,   -36,   -36,   131,   -36
+     -35,     4,   -35,   -35,    58,   -35,   -35,   -35,   -35,   -35,
+      -3,   -35,   -35,   -35,   -11,    -2,   -35,     0,   -35,    13,
+      65,   -10,    30,    -3,   -35,   -35,   -35,   141,   113,   -35,
+      24,    27,    15,   -14,   -35,    89,   -35,    32,    65,   -35,
+     -35,   -35,    19,    46,   -35,   120,    17,   -35,   -13,    29,
+     -35,   -35,   120,   120,    67,   141,   -35,   -35,   -35,    48,
+     -35,   -35,    47,   161,   -35,   120,   120,   120,   120,   120,
+     120,   120,   183,    50,    66,   -35,    52,   155,    97,    28,
+     120,   -35,   149,   110,   135,   164,    51,   -35,   172,   -35,
+     -35,   -35,   120,   -35,   -35,   120,   -35,   -35,   141,   -35,
+     142,   141,    61,   -35,   -35,   -35,   -35,   141,   -35
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
 static const yytype_int8 yydefact[] =
 {
-      54,     0,     3,     1,     8,    32,    33,    34,     2,     3,
-       0,     7,     4,    53,    56,     0,    35,    36,     0,    10,
-      11,     0,     0,    35,     0,     5,    12,    13,    35,     0,
-       0,     0,     0,     0,     0,    56,    35,    14,     0,     0,
-      45,    46,    21,    40,    42,    44,     0,     0,    41,     0,
-       0,    26,    27,     0,     0,     0,    35,     6,    15,    20,
-       0,    43,    47,     0,     0,    22,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,    29,     0,    30,    35,     0,
-       0,    37,    49,    48,    51,    50,    38,    39,    55,    58,
-      19,    28,     0,    16,    17,     0,    52,    35,    35,    31,
-       0,    25,    23,    18,    57,    56,    35,    24
+      55,     0,     3,     1,     2,     8,    32,    33,    34,     4,
+       0,     7,    53,    58,     0,    35,    36,     0,    10,    11,
+       0,     0,    35,     0,     5,    12,    13,    35,     0,    57,
+       0,     0,     0,     0,    58,    35,    14,     0,     0,    45,
+      46,    21,    40,    42,    44,     0,     0,    41,     0,     0,
+      26,    27,     0,     0,     0,    35,     6,    15,    20,     0,
+      43,    47,     0,     0,    22,     0,     0,     0,     0,     0,
+       0,     0,    54,     0,     0,    29,     0,    30,    35,     0,
+       0,    37,    49,    48,    51,    50,    38,    39,     0,    60,
+      19,    28,     0,    16,    17,     0,    52,    56,    35,    31,
+       0,    35,    23,    18,    25,    59,    58,    35,    24
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
-     -36,   -36,    98,   -36,   -36,   -36,   -36,    88,   -36,    59,
-     -35,   -28,    40,    -5,    -6,   -15,    90,   -36,   -36,   -33,
-     -36,   -36
+     -35,   -35,   -35,   -35,   -35,   -35,   -35,    74,   -35,    49,
+     -34,   -27,    20,   -15,     3,   -12,    90,   -35,   -35,   -35,
+     -35,   -31,   -35,   -35
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
+/* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-       0,     1,     8,     9,    28,    10,    18,    19,    20,    36,
-      37,    48,    76,    11,    39,    77,    14,     2,    97,    15,
-     105,    98
+       0,     1,     4,     9,    27,    10,    17,    18,    19,    35,
+      36,    47,    76,    11,    38,    77,    13,    73,     2,   101,
+      49,    14,   106,    98
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int8 yytable[] =
 {
-      38,    58,    56,    54,     3,    17,     5,     6,    38,     7,
-      21,    40,    41,    55,    49,    16,    24,    21,    94,    13,
-      43,    44,    45,    22,    95,    69,    70,    71,    38,    -9,
-      46,    62,    64,    47,    60,    72,    23,    65,    73,    74,
-      25,    17,    63,    58,    66,    67,    68,    69,    70,    71,
-      38,    82,    83,    84,    85,    86,    87,    67,    68,    69,
-      70,    71,   101,   102,    51,    96,    40,    41,    50,    38,
-      38,   107,   106,    52,    53,    43,    44,    45,    38,    59,
-     100,     5,     6,    55,     7,    46,    61,    17,    47,    75,
-      29,    30,    31,    32,    79,    17,    33,    34,    29,    30,
-      31,    32,    80,    91,    33,    34,   104,    12,    35,    57,
-      71,    26,    40,    41,    27,    78,    35,    93,    42,    40,
-      41,    43,    44,    45,    68,    69,    70,    71,    43,    44,
-      45,    46,    99,     0,    47,     0,     0,     0,    46,    17,
-       0,    47,    29,    30,    31,    32,     0,    90,    33,    34,
-     -10,    70,    71,     0,    66,    67,    68,    69,    70,    71,
-      35,   103,     4,     5,     6,     0,     7,     0,    66,    67,
-      68,    69,    70,    71,    92,     0,     0,     0,     0,     0,
-      66,    67,    68,    69,    70,    71,    66,    67,    68,    69,
-      70,    71,     0,     0,     0,     0,    81,    66,    67,    68,
-      69,    70,    71,     0,     0,     0,     0,    88,    66,    67,
-      68,    69,    70,    71,     0,     0,     0,     0,    89
+      37,    57,    64,    55,     3,    23,    16,    53,    37,    65,
+      66,    67,    68,    69,    70,    12,    48,    54,    20,    24,
+      15,     6,     7,    59,     8,    20,    39,    40,    37,    22,
+      -9,    62,    21,    61,    63,    42,    43,    44,    16,    50,
+      72,    74,    51,    94,    57,    45,    52,    58,    46,    95,
+      54,    37,    60,    82,    83,    84,    85,    86,    87,    88,
+      71,     5,     6,     7,   102,     8,    79,   104,    96,     6,
+       7,    37,     8,   108,    37,   107,    39,    40,    70,    80,
+      37,    90,    89,   100,    91,    42,    43,    44,    65,    66,
+      67,    68,    69,    70,   105,    45,    25,    16,    46,    75,
+      28,    29,    30,    31,    78,    16,    32,    33,    28,    29,
+      30,    31,    99,    26,    32,    33,     0,     0,    34,    56,
+       0,     0,    39,    40,     0,     0,    34,    93,    41,    39,
+      40,    42,    43,    44,    67,    68,    69,    70,    42,    43,
+      44,    45,     0,     0,    46,     0,     0,     0,    45,    16,
+       0,    46,    28,    29,    30,    31,     0,   103,    32,    33,
+      68,    69,    70,     0,    65,    66,    67,    68,    69,    70,
+      34,    92,    66,    67,    68,    69,    70,    65,    66,    67,
+      68,    69,    70,    65,    66,    67,    68,    69,    70,   -10,
+      69,    70,     0,    81,    65,    66,    67,    68,    69,    70,
+       0,     0,     0,     0,    97,    65,    66,    67,    68,    69,
+      70
 };
 
 static const yytype_int8 yycheck[] =
 {
-      28,    36,    35,    21,     0,     8,     4,     5,    36,     7,
-      16,     9,    10,    31,    29,    31,    21,    23,    15,    18,
-      18,    19,    20,    32,    21,    25,    26,    27,    56,    32,
-      28,    46,    47,    31,    39,    50,    16,    15,    53,    54,
-      29,     8,    47,    78,    22,    23,    24,    25,    26,    27,
-      78,    66,    67,    68,    69,    70,    71,    23,    24,    25,
-      26,    27,    97,    98,    15,    80,     9,    10,    31,    97,
-      98,   106,   105,    15,    31,    18,    19,    20,   106,    15,
-      95,     4,     5,    31,     7,    28,     6,     8,    31,    32,
-      11,    12,    13,    14,    18,     8,    17,    18,    11,    12,
-      13,    14,    32,    32,    17,    18,    33,     9,    29,    30,
-      27,    23,     9,    10,    24,    56,    29,    30,    15,     9,
+      27,    35,    15,    34,     0,    20,     8,    21,    35,    22,
+      23,    24,    25,    26,    27,    18,    28,    31,    15,    29,
+      31,     4,     5,    38,     7,    22,     9,    10,    55,    16,
+      32,    46,    32,    45,    46,    18,    19,    20,     8,    15,
+      52,    53,    15,    15,    78,    28,    31,    15,    31,    21,
+      31,    78,     6,    65,    66,    67,    68,    69,    70,    71,
+      31,     3,     4,     5,    98,     7,    18,   101,    80,     4,
+       5,    98,     7,   107,   101,   106,     9,    10,    27,    32,
+     107,    15,    32,    95,    32,    18,    19,    20,    22,    23,
+      24,    25,    26,    27,    33,    28,    22,     8,    31,    32,
+      11,    12,    13,    14,    55,     8,    17,    18,    11,    12,
+      13,    14,    92,    23,    17,    18,    -1,    -1,    29,    30,
+      -1,    -1,     9,    10,    -1,    -1,    29,    30,    15,     9,
       10,    18,    19,    20,    24,    25,    26,    27,    18,    19,
-      20,    28,    92,    -1,    31,    -1,    -1,    -1,    28,     8,
+      20,    28,    -1,    -1,    31,    -1,    -1,    -1,    28,     8,
       -1,    31,    11,    12,    13,    14,    -1,    15,    17,    18,
       25,    26,    27,    -1,    22,    23,    24,    25,    26,    27,
-      29,    15,     3,     4,     5,    -1,     7,    -1,    22,    23,
-      24,    25,    26,    27,    16,    -1,    -1,    -1,    -1,    -1,
-      22,    23,    24,    25,    26,    27,    22,    23,    24,    25,
-      26,    27,    -1,    -1,    -1,    -1,    32,    22,    23,    24,
-      25,    26,    27,    -1,    -1,    -1,    -1,    32,    22,    23,
-      24,    25,    26,    27,    -1,    -1,    -1,    -1,    32
+      29,    16,    23,    24,    25,    26,    27,    22,    23,    24,
+      25,    26,    27,    22,    23,    24,    25,    26,    27,    25,
+      26,    27,    -1,    32,    22,    23,    24,    25,    26,    27,
+      -1,    -1,    -1,    -1,    32,    22,    23,    24,    25,    26,
+      27
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
 static const yytype_int8 yystos[] =
 {
-       0,    35,    51,     0,     3,     4,     5,     7,    36,    37,
-      39,    47,    36,    18,    50,    53,    31,     8,    40,    41,
-      42,    48,    32,    16,    47,    29,    41,    50,    38,    11,
-      12,    13,    14,    17,    18,    29,    43,    44,    45,    48,
-       9,    10,    15,    18,    19,    20,    28,    31,    45,    49,
-      31,    15,    15,    31,    21,    31,    53,    30,    44,    15,
-      47,     6,    49,    47,    49,    15,    22,    23,    24,    25,
-      26,    27,    49,    49,    49,    32,    46,    49,    43,    18,
-      32,    32,    49,    49,    49,    49,    49,    49,    32,    32,
-      15,    32,    16,    30,    15,    21,    49,    52,    55,    46,
-      49,    44,    44,    15,    33,    54,    53,    44
+       0,    35,    52,     0,    36,     3,     4,     5,     7,    37,
+      39,    47,    18,    50,    55,    31,     8,    40,    41,    42,
+      48,    32,    16,    47,    29,    41,    50,    38,    11,    12,
+      13,    14,    17,    18,    29,    43,    44,    45,    48,     9,
+      10,    15,    18,    19,    20,    28,    31,    45,    49,    54,
+      15,    15,    31,    21,    31,    55,    30,    44,    15,    47,
+       6,    49,    47,    49,    15,    22,    23,    24,    25,    26,
+      27,    31,    49,    51,    49,    32,    46,    49,    43,    18,
+      32,    32,    49,    49,    49,    49,    49,    49,    49,    32,
+      15,    32,    16,    30,    15,    21,    49,    32,    57,    46,
+      49,    53,    44,    15,    44,    33,    56,    55,    44
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
        0,    34,    35,    36,    36,    38,    37,    39,    39,    40,
@@ -733,18 +735,20 @@ static const yytype_int8 yyr1[] =
       44,    44,    44,    44,    44,    44,    44,    44,    45,    45,
       46,    46,    47,    47,    47,    48,    48,    49,    49,    49,
       49,    49,    49,    49,    49,    49,    49,    49,    49,    49,
-      49,    49,    49,    50,    51,    52,    53,    54,    55
+      49,    49,    49,    50,    51,    52,    53,    54,    55,    56,
+      57
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
        0,     2,     2,     0,     2,     0,    10,     1,     1,     0,
        1,     1,     3,     3,     1,     2,     4,     4,     6,     4,
-       2,     2,     3,     6,    10,     6,     2,     2,     4,     3,
+       2,     2,     3,     6,    10,     7,     2,     2,     4,     3,
        1,     3,     1,     1,     1,     0,     1,     3,     3,     3,
        1,     1,     1,     2,     1,     1,     1,     2,     3,     3,
-       3,     3,     4,     1,     0,     0,     0,     0,     0
+       3,     3,     4,     1,     1,     0,     0,     0,     0,     0,
+       0
 };
 
 
@@ -756,6 +760,7 @@ enum { YYENOMEM = -2 };
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
@@ -796,10 +801,7 @@ do {                                            \
     YYFPRINTF Args;                             \
 } while (0)
 
-/* This macro is provided for backward compatibility. */
-# ifndef YY_LOCATION_PRINT
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
+
 
 
 # define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
@@ -826,10 +828,6 @@ yy_symbol_value_print (FILE *yyo,
   YY_USE (yyoutput);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yykind < YYNTOKENS)
-    YYPRINT (yyo, yytoknum[yykind], *yyvaluep);
-# endif
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
@@ -1014,6 +1012,7 @@ yyparse (void)
   YYDPRINTF ((stderr, "Starting parse\n"));
 
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   goto yysetstate;
 
 
@@ -1039,7 +1038,7 @@ yysetstate:
 
   if (yyss + yystacksize - 1 <= yyssp)
 #if !defined yyoverflow && !defined YYSTACK_RELOCATE
-    goto yyexhaustedlab;
+    YYNOMEM;
 #else
     {
       /* Get the current used size of the three stacks, in elements.  */
@@ -1067,7 +1066,7 @@ yysetstate:
 # else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
@@ -1078,7 +1077,7 @@ yysetstate:
           YY_CAST (union yyalloc *,
                    YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
@@ -1100,6 +1099,7 @@ yysetstate:
     }
 #endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
+
   if (yystate == YYFINAL)
     YYACCEPT;
 
@@ -1212,25 +1212,25 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* Program: M_ENTER_GLOBAL Funcs  */
-#line 43 "parser.ypp"
+#line 48 "parser.ypp"
                                                                      { yyval = new Program(); check_for_main_correctness(); }
 #line 1218 "parser.tab.cpp"
     break;
 
   case 3: /* Funcs: %empty  */
-#line 44 "parser.ypp"
+#line 49 "parser.ypp"
                                                                      { yyval = new Funcs(); }
 #line 1224 "parser.tab.cpp"
     break;
 
-  case 4: /* Funcs: FuncDecl Funcs  */
-#line 45 "parser.ypp"
+  case 4: /* Funcs: Funcs FuncDecl  */
+#line 50 "parser.ypp"
                                                                      { yyval = new Funcs(); }
 #line 1230 "parser.tab.cpp"
     break;
 
   case 5: /* @1: %empty  */
-#line 47 "parser.ypp"
+#line 52 "parser.ypp"
 { 
     yyval =  new FuncDecl(dynamic_cast<RetType*>(yyvsp[-6]), dynamic_cast<IDWrap*>(yyvsp[-5]), dynamic_cast<Formals*>(yyvsp[-2]));
 }
@@ -1238,327 +1238,339 @@ yyreduce:
     break;
 
   case 6: /* FuncDecl: RetType IDWrap M_NEW_SCOPE LPAREN Formals RPAREN LBRACE @1 Statements RBRACE  */
-#line 49 "parser.ypp"
-                    { destroy_current_scope(); }
+#line 54 "parser.ypp"
+                    { if (body_ir_enabled) body_finished(dynamic_cast<Statements*>(yyvsp[-1])); destroy_current_scope(); }
 #line 1244 "parser.tab.cpp"
     break;
 
   case 7: /* RetType: Type  */
-#line 50 "parser.ypp"
+#line 55 "parser.ypp"
                                                                      { yyval = new RetType(dynamic_cast<Type*>(yyvsp[0])); }
 #line 1250 "parser.tab.cpp"
     break;
 
   case 8: /* RetType: VOID  */
-#line 51 "parser.ypp"
+#line 56 "parser.ypp"
                                                                      { yyval = new RetType(yyvsp[0]); }
 #line 1256 "parser.tab.cpp"
     break;
 
   case 9: /* Formals: %empty  */
-#line 52 "parser.ypp"
+#line 57 "parser.ypp"
                                                                      { yyval = new Formals(); }
 #line 1262 "parser.tab.cpp"
     break;
 
   case 10: /* Formals: FormalsList  */
-#line 53 "parser.ypp"
+#line 58 "parser.ypp"
                                                                      { yyval = new Formals(dynamic_cast<FormalsList*>(yyvsp[0])); }
 #line 1268 "parser.tab.cpp"
     break;
 
   case 11: /* FormalsList: FormalDecl  */
-#line 54 "parser.ypp"
+#line 59 "parser.ypp"
                                                                      { yyval = new FormalsList(dynamic_cast<FormalDecl*>(yyvsp[0])); }
 #line 1274 "parser.tab.cpp"
     break;
 
   case 12: /* FormalsList: FormalDecl COMMA FormalsList  */
-#line 55 "parser.ypp"
+#line 60 "parser.ypp"
                                                                      { yyval = new FormalsList(dynamic_cast<FormalDecl*>(yyvsp[-2]), dynamic_cast<FormalsList*>(yyvsp[0])); }
 #line 1280 "parser.tab.cpp"
     break;
 
   case 13: /* FormalDecl: TypeAnnotation Type IDWrap  */
-#line 56 "parser.ypp"
+#line 61 "parser.ypp"
                                                                      { yyval = new FormalDecl(dynamic_cast<Type*>(yyvsp[-1]), dynamic_cast<IDWrap*>(yyvsp[0]), dynamic_cast<TypeAnnotation*>(yyvsp[-2])); }
 #line 1286 "parser.tab.cpp"
     break;
 
   case 14: /* Statements: Statement  */
-#line 57 "parser.ypp"
+#line 62 "parser.ypp"
                                                                      { yyval = new Statements(dynamic_cast<Statement*>(yyvsp[0])); }
 #line 1292 "parser.tab.cpp"
     break;
 
   case 15: /* Statements: Statements Statement  */
-#line 58 "parser.ypp"
+#line 63 "parser.ypp"
                                                                      { yyval = new Statements(dynamic_cast<Statements*>(yyvsp[-1]), dynamic_cast<Statement*>(yyvsp[0])); }
 #line 1298 "parser.tab.cpp"
     break;
 
   case 16: /* Statement: LBRACE M_NEW_SCOPE Statements RBRACE  */
-#line 59 "parser.ypp"
+#line 64 "parser.ypp"
                                                                      { yyval = new Statement(dynamic_cast<Statements*>(yyvsp[-1])); destroy_current_scope(); }
 #line 1304 "parser.tab.cpp"
     break;
 
   case 17: /* Statement: TypeAnnotation Type ID SC  */
-#line 60 "parser.ypp"
+#line 65 "parser.ypp"
                                                                      { yyval = new Statement(dynamic_cast<Type*>(yyvsp[-2]), yyvsp[-1], dynamic_cast<TypeAnnotation*>(yyvsp[-3])); }
 #line 1310 "parser.tab.cpp"
     break;
 
   case 18: /* Statement: TypeAnnotation Type ID ASSIGN Exp SC  */
-#line 61 "parser.ypp"
+#line 66 "parser.ypp"
                                                                      { yyval = new Statement(dynamic_cast<Type*>(yyvsp[-4]), yyvsp[-3], dynamic_cast<Exp*>(yyvsp[-1]), dynamic_cast<TypeAnnotation*>(yyvsp[-5])); }
 #line 1316 "parser.tab.cpp"
     break;
 
   case 19: /* Statement: ID ASSIGN Exp SC  */
-#line 62 "parser.ypp"
+#line 67 "parser.ypp"
                                                                      { yyval = new Statement(yyvsp[-3], dynamic_cast<Exp*>(yyvsp[-1])); }
 #line 1322 "parser.tab.cpp"
     break;
 
   case 20: /* Statement: Call SC  */
-#line 63 "parser.ypp"
+#line 68 "parser.ypp"
                                                                      { yyval = new Statement(dynamic_cast<Call*>(yyvsp[-1])); }
 #line 1328 "parser.tab.cpp"
     break;
 
   case 21: /* Statement: RETURN SC  */
-#line 64 "parser.ypp"
+#line 69 "parser.ypp"
                                                                      { yyval = new Statement(); }
 #line 1334 "parser.tab.cpp"
     break;
 
   case 22: /* Statement: RETURN Exp SC  */
-#line 65 "parser.ypp"
+#line 70 "parser.ypp"
                                                                      { yyval = new Statement(dynamic_cast<Exp*>(yyvsp[-1])); }
 #line 1340 "parser.tab.cpp"
     break;
 
-  case 23: /* Statement: IF LPAREN Exp RPAREN M_ENTER_IF Statement  */
-#line 66 "parser.ypp"
-                                                                     { yyval = new Statement("IF", dynamic_cast<Exp*>(yyvsp[-3])); destroy_current_scope(); }
+  case 23: /* Statement: IF LPAREN ExpWrap RPAREN M_ENTER_IF Statement  */
+#line 71 "parser.ypp"
+                                                                     { yyval = new Statement("IF", dynamic_cast<Exp*>(yyvsp[-3]), dynamic_cast<Statement*>(yyvsp[0])); destroy_current_scope(); }
 #line 1346 "parser.tab.cpp"
     break;
 
-  case 24: /* Statement: IF LPAREN Exp RPAREN M_ENTER_IF Statement ELSE M_DES_SCOPE M_NEW_SCOPE Statement  */
-#line 68 "parser.ypp"
+  case 24: /* Statement: IF LPAREN ExpWrap RPAREN M_ENTER_IF Statement ELSE M_DES_SCOPE M_NEW_SCOPE Statement  */
+#line 73 "parser.ypp"
 {
-    yyval = new Statement("IF", dynamic_cast<Exp*>(yyvsp[-7])); destroy_current_scope(); 
+    yyval = new Statement("IF", dynamic_cast<Exp*>(yyvsp[-7]), dynamic_cast<Statement*>(yyvsp[-4]), dynamic_cast<Statement*>(yyvsp[0])); destroy_current_scope(); 
 }
 #line 1354 "parser.tab.cpp"
     break;
 
-  case 25: /* Statement: WHILE LPAREN Exp RPAREN M_WHILE_ENTER Statement  */
-#line 71 "parser.ypp"
-                                                                     { yyval = new Statement("WHILE", dynamic_cast<Exp*>(yyvsp[-3])); destroy_current_scope(); loop_exited(); }
+  case 25: /* Statement: WHILE M_LOOP_HEAD LPAREN Exp RPAREN M_WHILE_ENTER Statement  */
+#line 76 "parser.ypp"
+                                                                        { yyval = new Statement("WHILE", dynamic_cast<Exp*>(yyvsp[-3]), dynamic_cast<Statement*>(yyvsp[0])); destroy_current_scope(); loop_exited(); }
 #line 1360 "parser.tab.cpp"
     break;
 
   case 26: /* Statement: BREAK SC  */
-#line 72 "parser.ypp"
+#line 77 "parser.ypp"
                                                                      { yyval = new Statement(Break_Cont::BREAK); }
 #line 1366 "parser.tab.cpp"
     break;
 
   case 27: /* Statement: CONTINUE SC  */
-#line 73 "parser.ypp"
+#line 78 "parser.ypp"
                                                                      { yyval = new Statement(Break_Cont::CONTINUE); }
 #line 1372 "parser.tab.cpp"
     break;
 
   case 28: /* Call: ID LPAREN ExpList RPAREN  */
-#line 74 "parser.ypp"
+#line 79 "parser.ypp"
                                                                      { yyval = new Call(yyvsp[-3], dynamic_cast<ExpList*>(yyvsp[-1])); }
 #line 1378 "parser.tab.cpp"
     break;
 
   case 29: /* Call: ID LPAREN RPAREN  */
-#line 75 "parser.ypp"
+#line 80 "parser.ypp"
                                                                      { yyval = new Call(yyvsp[-2]); }
 #line 1384 "parser.tab.cpp"
     break;
 
   case 30: /* ExpList: Exp  */
-#line 76 "parser.ypp"
+#line 81 "parser.ypp"
                                                                      { yyval = new ExpList(dynamic_cast<Exp*>(yyvsp[0])); }
 #line 1390 "parser.tab.cpp"
     break;
 
   case 31: /* ExpList: Exp COMMA ExpList  */
-#line 77 "parser.ypp"
+#line 82 "parser.ypp"
                                                                      { yyval = new ExpList(dynamic_cast<Exp*>(yyvsp[-2]), dynamic_cast<ExpList*>(yyvsp[0])); }
 #line 1396 "parser.tab.cpp"
     break;
 
   case 32: /* Type: INT  */
-#line 78 "parser.ypp"
-                                                                     { yyval = new Type(yyvsp[0]); }
+#line 83 "parser.ypp"
+                                                                     { yyval = new Type(yyvsp[0], TypeId::INT); }
 #line 1402 "parser.tab.cpp"
     break;
 
   case 33: /* Type: BYTE  */
-#line 79 "parser.ypp"
-                                                                     { yyval = new Type(yyvsp[0]); }
+#line 84 "parser.ypp"
+                                                                     { yyval = new Type(yyvsp[0], TypeId::BYTE); }
 #line 1408 "parser.tab.cpp"
     break;
 
   case 34: /* Type: BOOL  */
-#line 80 "parser.ypp"
-                                                                     { yyval = new Type(yyvsp[0]); }
+#line 85 "parser.ypp"
+                                                                     { yyval = new Type(yyvsp[0], TypeId::BOOL); }
 #line 1414 "parser.tab.cpp"
     break;
 
   case 35: /* TypeAnnotation: %empty  */
-#line 81 "parser.ypp"
+#line 86 "parser.ypp"
                                                                      { yyval = new TypeAnnotation(); }
 #line 1420 "parser.tab.cpp"
     break;
 
   case 36: /* TypeAnnotation: CONST  */
-#line 82 "parser.ypp"
+#line 87 "parser.ypp"
                                                                      { yyval = new TypeAnnotation(yyvsp[0]); }
 #line 1426 "parser.tab.cpp"
     break;
 
   case 37: /* Exp: LPAREN Exp RPAREN  */
-#line 83 "parser.ypp"
-                                                                     { yyval = new Exp(dynamic_cast<Exp*>(yyvsp[-1])); }
+#line 88 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(dynamic_cast<Exp*>(yyvsp[-1]))); }
 #line 1432 "parser.tab.cpp"
     break;
 
   case 38: /* Exp: Exp BINADD Exp  */
-#line 84 "parser.ypp"
-                                                                     { yyval = new Exp(dynamic_cast<Exp*>(yyvsp[-2]), OP_TYPE::BINADD, dynamic_cast<Exp*>(yyvsp[0])); }
+#line 89 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(dynamic_cast<Exp*>(yyvsp[-2]), OP_TYPE::BINADD, dynamic_cast<Exp*>(yyvsp[0]), yyvsp[-1])); }
 #line 1438 "parser.tab.cpp"
     break;
 
   case 39: /* Exp: Exp BINMUL Exp  */
-#line 85 "parser.ypp"
-                                                                     { yyval = new Exp(dynamic_cast<Exp*>(yyvsp[-2]), OP_TYPE::BINMUL, dynamic_cast<Exp*>(yyvsp[0])); }
+#line 90 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(dynamic_cast<Exp*>(yyvsp[-2]), OP_TYPE::BINMUL, dynamic_cast<Exp*>(yyvsp[0]), yyvsp[-1])); }
 #line 1444 "parser.tab.cpp"
     break;
 
   case 40: /* Exp: ID  */
-#line 86 "parser.ypp"
-                                                                     { yyval = new Exp(yyvsp[0]); }
+#line 91 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(yyvsp[0])); }
 #line 1450 "parser.tab.cpp"
     break;
 
   case 41: /* Exp: Call  */
-#line 87 "parser.ypp"
-                                                                     { yyval = new Exp(dynamic_cast<Call*>(yyvsp[0])); }
+#line 92 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(dynamic_cast<Call*>(yyvsp[0]))); }
 #line 1456 "parser.tab.cpp"
     break;
 
   case 42: /* Exp: NUM  */
-#line 88 "parser.ypp"
-                                                                     { yyval = new Exp(yyvsp[0], "INT"); }
+#line 93 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(yyvsp[0], TypeId::INT)); }
 #line 1462 "parser.tab.cpp"
     break;
 
   case 43: /* Exp: NUM B  */
-#line 89 "parser.ypp"
-                                                                     { yyval = new Exp(yyvsp[-1], "BYTE"); }
+#line 94 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(yyvsp[-1], TypeId::BYTE)); }
 #line 1468 "parser.tab.cpp"
     break;
 
   case 44: /* Exp: STRING  */
-#line 90 "parser.ypp"
-                                                                     { yyval = new Exp(yyvsp[0], "STRING"); }
+#line 95 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(yyvsp[0], TypeId::STRING)); }
 #line 1474 "parser.tab.cpp"
     break;
 
   case 45: /* Exp: TRUE  */
-#line 91 "parser.ypp"
-                                                                     { yyval = new Exp(yyvsp[0], "BOOL"); }
+#line 96 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(yyvsp[0], TypeId::BOOL)); }
 #line 1480 "parser.tab.cpp"
     break;
 
   case 46: /* Exp: FALSE  */
-#line 92 "parser.ypp"
-                                                                     { yyval = new Exp(yyvsp[0], "BOOL"); }
+#line 97 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(yyvsp[0], TypeId::BOOL)); }
 #line 1486 "parser.tab.cpp"
     break;
 
   case 47: /* Exp: NOT Exp  */
-#line 93 "parser.ypp"
-                                                                     { yyval = new Exp(true, dynamic_cast<Exp*>(yyvsp[0])); }
+#line 98 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(true, dynamic_cast<Exp*>(yyvsp[0]))); }
 #line 1492 "parser.tab.cpp"
     break;
 
   case 48: /* Exp: Exp AND Exp  */
-#line 94 "parser.ypp"
-                                                                     { yyval = new Exp(dynamic_cast<Exp*>(yyvsp[-2]), OP_TYPE::AND, dynamic_cast<Exp*>(yyvsp[0])); }
+#line 99 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(dynamic_cast<Exp*>(yyvsp[-2]), OP_TYPE::AND, dynamic_cast<Exp*>(yyvsp[0]), yyvsp[-1])); }
 #line 1498 "parser.tab.cpp"
     break;
 
   case 49: /* Exp: Exp OR Exp  */
-#line 95 "parser.ypp"
-                                                                     { yyval = new Exp(dynamic_cast<Exp*>(yyvsp[-2]), OP_TYPE::OR, dynamic_cast<Exp*>(yyvsp[0])); }
+#line 100 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(dynamic_cast<Exp*>(yyvsp[-2]), OP_TYPE::OR, dynamic_cast<Exp*>(yyvsp[0]), yyvsp[-1])); }
 #line 1504 "parser.tab.cpp"
     break;
 
   case 50: /* Exp: Exp RELATION Exp  */
-#line 96 "parser.ypp"
-                                                                     { yyval = new Exp(dynamic_cast<Exp*>(yyvsp[-2]), OP_TYPE::RELATION, dynamic_cast<Exp*>(yyvsp[0])); }
+#line 101 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(dynamic_cast<Exp*>(yyvsp[-2]), OP_TYPE::RELATION, dynamic_cast<Exp*>(yyvsp[0]), yyvsp[-1])); }
 #line 1510 "parser.tab.cpp"
     break;
 
   case 51: /* Exp: Exp EQUALITY Exp  */
-#line 97 "parser.ypp"
-                                                                     { yyval = new Exp(dynamic_cast<Exp*>(yyvsp[-2]), OP_TYPE::EQUALITY, dynamic_cast<Exp*>(yyvsp[0])); }
+#line 102 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(dynamic_cast<Exp*>(yyvsp[-2]), OP_TYPE::EQUALITY, dynamic_cast<Exp*>(yyvsp[0]), yyvsp[-1])); }
 #line 1516 "parser.tab.cpp"
     break;
 
   case 52: /* Exp: LPAREN Type RPAREN Exp  */
-#line 98 "parser.ypp"
-                                                                     { yyval = new Exp(dynamic_cast<Type*>(yyvsp[-2]), dynamic_cast<Exp*>(yyvsp[0])); }
+#line 103 "parser.ypp"
+                                                                     { yyval = Exp::share(new Exp(dynamic_cast<Type*>(yyvsp[-2]), dynamic_cast<Exp*>(yyvsp[0]))); }
 #line 1522 "parser.tab.cpp"
     break;
 
   case 53: /* IDWrap: ID  */
-#line 99 "parser.ypp"
+#line 104 "parser.ypp"
                                                                      { yyval = new IDWrap(yyvsp[0], yylineno); }
 #line 1528 "parser.tab.cpp"
     break;
 
-  case 54: /* M_ENTER_GLOBAL: %empty  */
-#line 100 "parser.ypp"
-                                                                     { create_global_scope(); }
+  case 54: /* ExpWrap: Exp  */
+#line 105 "parser.ypp"
+                                                                     { yyval = checkBoolExp(dynamic_cast<Exp*>(yyvsp[0])); }
 #line 1534 "parser.tab.cpp"
     break;
 
-  case 55: /* M_WHILE_ENTER: %empty  */
-#line 101 "parser.ypp"
-                                                                     { create_new_scope(); loop_entered(); }
+  case 55: /* M_ENTER_GLOBAL: %empty  */
+#line 106 "parser.ypp"
+                                                                     { create_global_scope(); }
 #line 1540 "parser.tab.cpp"
     break;
 
-  case 56: /* M_NEW_SCOPE: %empty  */
-#line 102 "parser.ypp"
-                                                                     { create_new_scope(); }
+  case 56: /* M_WHILE_ENTER: %empty  */
+#line 107 "parser.ypp"
+                                                                     { create_new_scope(); loop_entered(); }
 #line 1546 "parser.tab.cpp"
     break;
 
-  case 57: /* M_DES_SCOPE: %empty  */
-#line 103 "parser.ypp"
-                                                                     { destroy_current_scope(); }
+  case 57: /* M_LOOP_HEAD: %empty  */
+#line 108 "parser.ypp"
+                                                                     { loop_head_reached(); }
 #line 1552 "parser.tab.cpp"
     break;
 
-  case 58: /* M_ENTER_IF: %empty  */
-#line 104 "parser.ypp"
-                                                                     { create_new_scope(); enter_if(); }
+  case 58: /* M_NEW_SCOPE: %empty  */
+#line 109 "parser.ypp"
+                                                                     { create_new_scope(); }
 #line 1558 "parser.tab.cpp"
     break;
 
+  case 59: /* M_DES_SCOPE: %empty  */
+#line 110 "parser.ypp"
+                                                                     { destroy_current_scope(); }
+#line 1564 "parser.tab.cpp"
+    break;
+
+  case 60: /* M_ENTER_IF: %empty  */
+#line 111 "parser.ypp"
+                                                                     { create_new_scope(); enter_if(); }
+#line 1570 "parser.tab.cpp"
+    break;
 
-#line 1562 "parser.tab.cpp"
+
+#line 1574 "parser.tab.cpp"
 
       default: break;
     }
@@ -1640,6 +1652,7 @@ yyerrorlab:
      label yyerrorlab therefore never appears in user code.  */
   if (0)
     YYERROR;
+  ++yynerrs;
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
@@ -1700,7 +1713,7 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
 /*-----------------------------------.
@@ -1708,24 +1721,22 @@ yyacceptlab:
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
-#if !defined yyoverflow
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (YY_("memory exhausted"));
   yyresult = 2;
-  goto yyreturn;
-#endif
+  goto yyreturnlab;
 
 
-/*-------------------------------------------------------.
-| yyreturn -- parsing is finished, clean up and return.  |
-`-------------------------------------------------------*/
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -1752,14 +1763,14 @@ yyreturn:
   return yyresult;
 }
 
-#line 105 "parser.ypp"
+#line 112 "parser.ypp"
 
 
-int main() {
-    return yyparse();
+int main(int argc, char* argv[]) {
+    return run_analyzer(argc, argv);
 }
 
 void yyerror(char const* s) {
     errorSyn(yylineno);
-    exit(0);
+    fatal_error(yylineno);
 }
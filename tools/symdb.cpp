@@ -0,0 +1,59 @@
+// Answers questions from a --symbol-db file without running the analyzer again.
+// build: make tools/symdb
+// run:   tools/symdb FILE function NAME   signature, callees and callers
+//        tools/symdb FILE symbol NAME     every variable called NAME, with its function, type and offset
+//        tools/symdb FILE taking TYPE     functions with a parameter of TYPE, e.g. BYTE
+#include "../SymbolDb.h"
+#include <cstdio>
+#include <cstring>
+
+static const char* function_name(const SymbolDb& db, int function) {
+    return function < 0 ? "(global)" : db.text(db.function(function).name);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 4) {
+        fprintf(stderr, "usage: %s FILE function|symbol|taking ARG\n", argv[0]);
+        return 1;
+    }
+    SymbolDb db;
+    if (!db.open(argv[1])) {
+        fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[1]);
+        return 1;
+    }
+    const char* query = argv[2];
+    const char* arg = argv[3];
+    if (strcmp(query, "function") == 0) {
+        int f = db.find_function(arg);
+        if (f < 0)
+            return 1;
+        const DbFunction& function = db.function(f);
+        printf("%s %s\n", db.text(function.name), db.text(function.signature));
+        for (uint32_t i = 0; i < function.callees.count; i++)
+            printf("calls %s\n", function_name(db, db.callees(function)[i]));
+        for (uint32_t i = 0; i < function.callers.count; i++)
+            printf("called by %s\n", function_name(db, db.callers(function)[i]));
+    } else if (strcmp(query, "symbol") == 0) {
+        const uint32_t* first;
+        const uint32_t* last;
+        for (db.find_symbols(arg, &first, &last); first != last; first++) {
+            const DbSymbol& symbol = db.symbol(*first);
+            printf("%s %s%s %d\n", function_name(db, db.scope(symbol.scope).function),
+                   symbol.is_const ? "const " : "", db_type_names[symbol.type], symbol.offset);
+        }
+    } else if (strcmp(query, "taking") == 0) {
+        for (uint32_t f = 0; f < db.num_functions(); f++) {
+            const DbFunction& function = db.function(f);
+            for (uint32_t i = 0; i < function.params.count; i++) {
+                if (strcmp(db_type_names[db.params(function)[i].type], arg) == 0) {
+                    printf("%s %s\n", db.text(function.name), db.text(function.signature));
+                    break;
+                }
+            }
+        }
+    } else {
+        fprintf(stderr, "%s: unknown query %s\n", argv[0], query);
+        return 1;
+    }
+    return 0;
+}